@@ -0,0 +1,277 @@
+// Runs any number of (day, input file) jobs in one process, e.g.
+//   aoc 1:day_1_input.txt 5:day_5_input.txt
+//   aoc --manifest=jobs.txt --threads=0
+// where every non-empty line of the manifest is "<day> <path>" ('#' starts a comment).
+// The thread pool and parse buffers are created once and reused by every job. A path of "-" streams the input
+// from stdin through a fixed size buffer instead of mapping it, e.g.
+//   upstream-pipeline | aoc 6:-
+// --cache_dir keeps a binary parse of every input there, keyed by a hash of its contents, so solving the same input
+// again maps that instead of parsing the text.
+// A path that is a directory or a glob solves every file it names as a separate input, reading ahead with
+// io_uring (or reader threads) while earlier files are solved, e.g.
+//   aoc '6:regressions/day_6/*.txt' 2:replays/day_2
+// --profile_json writes the time, allocations and hardware counters of every job's read, parse, solve and output
+// phases as JSON.
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <memory>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "batch_reader.h"
+#include "input_reader.h"
+#include "instrumentation.h"
+#include "parsed_input_cache.h"
+#include "solver_registry.h"
+
+ABSL_FLAG(int, threads, 0, "Threads shared by all jobs, 0 for one per core");
+ABSL_FLAG(std::string, manifest, "", "File listing one \"<day> <path>\" job per line");
+ABSL_FLAG(std::string, cache_dir, "", "Directory to cache parsed inputs in, empty to always parse");
+ABSL_FLAG(int, max_in_flight, 32, "Files of a directory or glob job to read ahead of the one being solved");
+ABSL_FLAG(std::string, profile_json, "", "File to write per-phase timings and counters of every job to, - for stderr");
+
+struct Job
+{
+    int day;
+    std::string path;
+};
+
+// Parses "<day>:<path>" (command line) or "<day> <path>" (manifest)
+absl::StatusOr<Job> parse_job(std::string_view job_string)
+{
+    std::size_t separator = job_string.find_first_of(": ");
+    int day = 0;
+    if (separator == std::string_view::npos ||
+        std::from_chars(job_string.data(), job_string.data() + separator, day).ec != std::errc())
+    {
+        return absl::InvalidArgumentError(absl::StrFormat("expected <day>:<path>, got \"%s\"", job_string));
+    }
+    std::string_view path = job_string.substr(separator + 1);
+    path.remove_prefix(std::min(path.find_first_not_of(' '), path.size()));
+    if (path.empty())
+    {
+        return absl::InvalidArgumentError(absl::StrFormat("missing path in \"%s\"", job_string));
+    }
+    return Job{day, std::string(path)};
+}
+
+absl::Status read_manifest(std::string_view manifest_path, std::vector<Job> &jobs)
+{
+    auto manifest = MappedFile::open(manifest_path);
+    if (!manifest.ok())
+    {
+        return manifest.status();
+    }
+    absl::Status status;
+    for_each_line(manifest->contents(), [&](std::string_view line)
+    {
+        line = line.substr(0, line.find('#'));
+        line.remove_prefix(std::min(line.find_first_not_of(' '), line.size()));
+        line.remove_suffix(line.size() - std::min(line.find_last_not_of(' ') + 1, line.size()));
+        if (line.empty() || !status.ok())
+        {
+            return;
+        }
+        auto job = parse_job(line);
+        if (job.ok())
+        {
+            jobs.push_back(*std::move(job));
+        }
+        else
+        {
+            status = job.status();
+        }
+    });
+    return status;
+}
+
+// Solves |contents| as |day|'s input, through the parsed input cache if there is one
+absl::StatusOr<std::string> solve_contents(int day, std::string_view contents, SolveContext &context)
+{
+    if (absl::GetFlag(FLAGS_cache_dir).empty())
+    {
+        auto solver = find_solver(day);
+        if (!solver.ok())
+        {
+            return solver.status();
+        }
+        return (*solver)(contents, context);
+    }
+    auto cached_solver = find_cached_solver(day);
+    if (!cached_solver.ok())
+    {
+        return cached_solver.status();
+    }
+    auto cached = [&]
+    {
+        // Only hashing the input on a hit, parsing it and writing the cache on a miss
+        ScopedPhase phase(context.profiler, "cache");
+        return load_or_build_cached_input(absl::GetFlag(FLAGS_cache_dir), day, contents);
+    }();
+    if (!cached.ok())
+    {
+        return cached.status();
+    }
+    return (*cached_solver)(*cached, context);
+}
+
+absl::StatusOr<std::string> solve_job(const Job &job, SolveContext &context)
+{
+    if (job.path == "-")
+    {
+        auto stream_solver = find_stream_solver(job.day);
+        if (!stream_solver.ok())
+        {
+            return stream_solver.status();
+        }
+        return (*stream_solver)(STDIN_FILENO, context);
+    }
+    // The mapping is faulted in lazily, so most of the cost of reading a file shows up in the parse phase
+    auto input_file = [&]
+    {
+        ScopedPhase phase(context.profiler, "read");
+        return MappedFile::open(job.path);
+    }();
+    if (!input_file.ok())
+    {
+        return input_file.status();
+    }
+    return solve_contents(job.day, input_file->contents(), context);
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<char *> positional_args = absl::ParseCommandLine(argc, argv);
+    std::vector<Job> jobs;
+    if (!absl::GetFlag(FLAGS_manifest).empty())
+    {
+        absl::Status status = read_manifest(absl::GetFlag(FLAGS_manifest), jobs);
+        if (!status.ok())
+        {
+            std::cerr << status << std::endl;
+            return -1;
+        }
+    }
+    // positional_args[0] is the program name
+    for (std::size_t i = 1; i < positional_args.size(); i++)
+    {
+        auto job = parse_job(positional_args[i]);
+        if (!job.ok())
+        {
+            std::cerr << job.status() << std::endl;
+            return -1;
+        }
+        jobs.push_back(*std::move(job));
+    }
+    if (jobs.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " [--threads=N] [--manifest=FILE] <day>:<path>..." << std::endl;
+        return -1;
+    }
+
+    SolveContext context(absl::GetFlag(FLAGS_threads));
+    bool profiling = !absl::GetFlag(FLAGS_profile_json).empty();
+    std::unique_ptr<PhaseProfiler> profiler;
+    std::string profile_json = "{\"jobs\": [";
+    bool first_profiled_job = true;
+    int failed_jobs = 0;
+    auto start_job = [&]
+    {
+        if (profiling)
+        {
+            profiler = std::make_unique<PhaseProfiler>();
+            context.profiler = profiler.get();
+        }
+    };
+    auto finish_job = [&](int day, std::string_view path, const absl::StatusOr<std::string> &result)
+    {
+        context.arena.reset();
+        {
+            ScopedPhase phase(context.profiler, "output");
+            if (result.ok())
+            {
+                std::cout << "day " << day << " " << path << ": " << *result << "\n";
+            }
+            else
+            {
+                std::cerr << "day " << day << " " << path << ": " << result.status() << std::endl;
+                failed_jobs++;
+            }
+        }
+        if (profiling)
+        {
+            absl::StrAppendFormat(&profile_json, "%s{\"day\": %d, \"path\": %s, \"ok\": %s, \"phases\": %s}",
+                                  first_profiled_job ? "" : ", ", day, json_quote(path),
+                                  result.ok() ? "true" : "false", profiler->to_json());
+            first_profiled_job = false;
+            context.profiler = nullptr;
+        }
+    };
+    for (const Job &job : jobs)
+    {
+        if (job.path == "-" || !is_batch_path(job.path))
+        {
+            start_job();
+            finish_job(job.day, job.path, solve_job(job, context));
+            continue;
+        }
+        auto paths = expand_input_paths(job.path);
+        if (!paths.ok())
+        {
+            start_job();
+            finish_job(job.day, job.path, paths.status());
+            continue;
+        }
+        // Every file of the batch is its own job with its own result line
+        std::unique_ptr<BatchReader> reader = BatchReader::create(*std::move(paths), absl::GetFlag(FLAGS_max_in_flight));
+        BatchFile file;
+        while (true)
+        {
+            start_job();
+            bool has_file = [&]
+            {
+                // Only the time spent waiting for the read, the rest of it overlaps with solving earlier files
+                ScopedPhase phase(context.profiler, "read");
+                return reader->next(file);
+            }();
+            if (!has_file)
+            {
+                context.profiler = nullptr;
+                break;
+            }
+            absl::StatusOr<std::string> result =
+                file.contents.ok() ? solve_contents(job.day, *file.contents, context) : file.contents.status();
+            finish_job(job.day, file.path, result);
+        }
+    }
+    std::cout << std::flush;
+    if (profiling)
+    {
+        profile_json += "]}\n";
+        if (absl::GetFlag(FLAGS_profile_json) == "-")
+        {
+            std::cerr << profile_json;
+        }
+        else
+        {
+            std::ofstream profile_file(absl::GetFlag(FLAGS_profile_json));
+            profile_file << profile_json;
+            if (!profile_file)
+            {
+                std::cerr << "unable to write " << absl::GetFlag(FLAGS_profile_json) << std::endl;
+                return -1;
+            }
+        }
+    }
+    return failed_jobs == 0 ? 0 : 1;
+}
@@ -0,0 +1,549 @@
+#include "batch_reader.h"
+
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+
+namespace
+{
+
+absl::Status errno_status(std::string_view what, std::string_view path, int error)
+{
+    std::string message = absl::StrFormat("unable to %s %s: %s", what, path, std::strerror(error));
+    return error == ENOENT ? absl::NotFoundError(message) : absl::InternalError(message);
+}
+
+// Opens |path| and sizes |buffer| to hold all of it. Returns the descriptor, which the caller must close.
+absl::StatusOr<int> open_for_read(const std::string &path, std::string &buffer)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return errno_status("open", path, errno);
+    }
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0)
+    {
+        int fstat_errno = errno;
+        ::close(fd);
+        return errno_status("stat", path, fstat_errno);
+    }
+    buffer.resize(file_stat.st_size);
+    return fd;
+}
+
+// Blocking read of the whole file, for the reader threads and for kernels whose io_uring can't read
+absl::StatusOr<std::string> read_file(const std::string &path)
+{
+    std::string contents;
+    auto fd = open_for_read(path, contents);
+    if (!fd.ok())
+    {
+        return fd.status();
+    }
+    std::size_t bytes_read = 0;
+    while (bytes_read < contents.size())
+    {
+        ssize_t result = ::pread(*fd, contents.data() + bytes_read, contents.size() - bytes_read, bytes_read);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            int read_errno = errno;
+            ::close(*fd);
+            if (result == 0)
+            {
+                // The file shrank since it was sized
+                contents.resize(bytes_read);
+                return contents;
+            }
+            return errno_status("read", path, read_errno);
+        }
+        bytes_read += result;
+    }
+    ::close(*fd);
+    return contents;
+}
+
+// Reader threads pull the next path to read, but never get more than |max_in_flight| files ahead of the caller
+// so a slow solver doesn't end up with the whole batch in memory.
+class ThreadBatchReader : public BatchReader
+{
+public:
+    ThreadBatchReader(std::vector<std::string> paths, int max_in_flight)
+        : files_(paths.size()), max_in_flight_(std::max(max_in_flight, 1))
+    {
+        for (std::size_t i = 0; i < paths.size(); i++)
+        {
+            files_[i].file.path = std::move(paths[i]);
+        }
+        // Reading is all waiting, a handful of threads is enough to keep the device busy
+        std::size_t num_threads = std::min<std::size_t>({max_in_flight_, 16, files_.size()});
+        for (std::size_t i = 0; i < num_threads; i++)
+        {
+            threads_.emplace_back([this] { read_loop(); });
+        }
+    }
+
+    ~ThreadBatchReader() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        window_moved_.notify_all();
+        for (std::thread &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    bool next(BatchFile &file) override
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (next_to_return_ == files_.size())
+        {
+            return false;
+        }
+        Slot &slot = files_[next_to_return_];
+        file_read_.wait(lock, [&slot] { return slot.done; });
+        file = std::move(slot.file);
+        next_to_return_++;
+        window_moved_.notify_all();
+        return true;
+    }
+
+    std::string_view backend() const override { return "threads"; }
+
+private:
+    struct Slot
+    {
+        BatchFile file{"", std::string()};
+        bool done = false;
+    };
+
+    void read_loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            window_moved_.wait(lock, [this]
+            {
+                return stop_ || next_to_read_ == files_.size() || next_to_read_ < next_to_return_ + max_in_flight_;
+            });
+            if (stop_ || next_to_read_ == files_.size())
+            {
+                return;
+            }
+            Slot &slot = files_[next_to_read_++];
+            lock.unlock();
+            slot.file.contents = read_file(slot.file.path);
+            lock.lock();
+            slot.done = true;
+            file_read_.notify_all();
+        }
+    }
+
+    std::vector<Slot> files_;
+    std::size_t max_in_flight_;
+    std::size_t next_to_read_ = 0;
+    std::size_t next_to_return_ = 0;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable window_moved_;
+    std::condition_variable file_read_;
+    std::vector<std::thread> threads_;
+};
+
+#if defined(__linux__)
+// Talks to io_uring through the raw system calls rather than liburing, which isn't available everywhere we build.
+// Opening and sizing each file is still a regular system call, the reads are what get batched: up to
+// |max_in_flight| of them are queued and one io_uring_enter both submits new reads and waits for any to finish.
+class IoUringBatchReader : public BatchReader
+{
+public:
+    // Returns nullptr if io_uring isn't available (old kernel, or blocked by seccomp).
+    static std::unique_ptr<IoUringBatchReader> create(std::vector<std::string> paths, int max_in_flight)
+    {
+        auto reader = std::unique_ptr<IoUringBatchReader>(new IoUringBatchReader(std::move(paths), max_in_flight));
+        return reader->setup_ring() ? std::move(reader) : nullptr;
+    }
+
+    ~IoUringBatchReader() override
+    {
+        // Wait out any reads still in flight, the kernel would otherwise write into freed buffers
+        while (num_in_flight_ > 0 && enter(1))
+        {
+            reap_completions();
+        }
+        for (Slot &slot : files_)
+        {
+            if (slot.fd >= 0)
+            {
+                ::close(slot.fd);
+            }
+        }
+        if (sqes_ != nullptr)
+        {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+        {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr)
+        {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ >= 0)
+        {
+            ::close(ring_fd_);
+        }
+    }
+
+    bool next(BatchFile &file) override
+    {
+        if (next_to_return_ == files_.size())
+        {
+            return false;
+        }
+        Slot &slot = files_[next_to_return_];
+        while (true)
+        {
+            queue_reads();
+            if (slot.done)
+            {
+                break;
+            }
+            if (!enter(1))
+            {
+                // The ring is broken, finish whatever is left with plain reads
+                fail_in_flight_reads();
+                break;
+            }
+            reap_completions();
+        }
+        file = std::move(slot.file);
+        next_to_return_++;
+        return true;
+    }
+
+    std::string_view backend() const override { return "io_uring"; }
+
+private:
+    struct Slot
+    {
+        BatchFile file{"", std::string()};
+        int fd = -1;
+        std::size_t bytes_read = 0;
+        bool done = false;
+    };
+
+    IoUringBatchReader(std::vector<std::string> paths, int max_in_flight)
+        : files_(paths.size()), max_in_flight_(std::max(max_in_flight, 1))
+    {
+        for (std::size_t i = 0; i < paths.size(); i++)
+        {
+            files_[i].file.path = std::move(paths[i]);
+        }
+    }
+
+    bool setup_ring()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, max_in_flight_, &params));
+        if (ring_fd_ < 0)
+        {
+            return false;
+        }
+        // The kernel may round the ring up, but never queue more reads than asked for
+        max_in_flight_ = std::min<std::size_t>(max_in_flight_, params.sq_entries);
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap)
+        {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = map_ring(sq_ring_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap ? sq_ring_ : map_ring(cq_ring_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(map_ring(sqes_size_, IORING_OFF_SQES));
+        if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr)
+        {
+            return false;
+        }
+        char *sq = static_cast<char *>(sq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        char *cq = static_cast<char *>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void *map_ring(std::size_t size, off_t offset)
+    {
+        void *ring = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+        return ring == MAP_FAILED ? nullptr : ring;
+    }
+
+    // Opens files and queues their reads until |max_in_flight_| are outstanding or the caller is that far behind.
+    void queue_reads()
+    {
+        while (next_to_open_ < files_.size() && next_to_open_ < next_to_return_ + max_in_flight_ &&
+               num_in_flight_ < max_in_flight_)
+        {
+            Slot &slot = files_[next_to_open_++];
+            std::string &buffer = *slot.file.contents;
+            auto fd = open_for_read(slot.file.path, buffer);
+            if (!fd.ok())
+            {
+                slot.file.contents = fd.status();
+                slot.done = true;
+                continue;
+            }
+            slot.fd = *fd;
+            if (buffer.empty())
+            {
+                finish(slot);
+                continue;
+            }
+            push_read(next_to_open_ - 1);
+        }
+        if (num_to_submit_ > 0)
+        {
+            enter(0);
+        }
+    }
+
+    void push_read(std::size_t index)
+    {
+        Slot &slot = files_[index];
+        std::string &buffer = *slot.file.contents;
+        // Only this thread writes the tail, the release store is what publishes the entry to the kernel
+        unsigned tail = *sq_tail_;
+        unsigned sqe_index = tail & sq_mask_;
+        io_uring_sqe &sqe = sqes_[sqe_index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = slot.fd;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer.data() + slot.bytes_read);
+        sqe.len = static_cast<uint32_t>(std::min<std::size_t>(buffer.size() - slot.bytes_read, UINT32_MAX));
+        sqe.off = slot.bytes_read;
+        sqe.user_data = index;
+        sq_array_[sqe_index] = sqe_index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        num_to_submit_++;
+        num_in_flight_++;
+    }
+
+    // Submits the queued reads and waits for at least |min_complete| to finish. Returns false if the ring failed.
+    bool enter(unsigned min_complete)
+    {
+        while (true)
+        {
+            int submitted = static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_, num_to_submit_, min_complete,
+                                                        min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+            if (submitted >= 0)
+            {
+                num_to_submit_ -= submitted;
+                return true;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                return false;
+            }
+        }
+    }
+
+    void reap_completions()
+    {
+        unsigned head = *cq_head_;
+        while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+        {
+            const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+            std::size_t index = cqe.user_data;
+            int result = cqe.res;
+            head++;
+            num_in_flight_--;
+            Slot &slot = files_[index];
+            if (result == -EINTR || result == -EAGAIN)
+            {
+                push_read(index);
+            }
+            else if (result == -EINVAL || result == -EOPNOTSUPP)
+            {
+                // The kernel has io_uring but not IORING_OP_READ (before 5.6)
+                ::close(std::exchange(slot.fd, -1));
+                slot.file.contents = read_file(slot.file.path);
+                slot.done = true;
+            }
+            else if (result < 0)
+            {
+                slot.file.contents = errno_status("read", slot.file.path, -result);
+                finish(slot);
+            }
+            else
+            {
+                slot.bytes_read += result;
+                if (result == 0)
+                {
+                    // The file shrank since it was sized
+                    slot.file.contents->resize(slot.bytes_read);
+                }
+                if (slot.bytes_read == slot.file.contents->size())
+                {
+                    finish(slot);
+                }
+                else
+                {
+                    push_read(index);
+                }
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+    void finish(Slot &slot)
+    {
+        ::close(std::exchange(slot.fd, -1));
+        slot.done = true;
+    }
+
+    void fail_in_flight_reads()
+    {
+        for (std::size_t i = next_to_return_; i < next_to_open_; i++)
+        {
+            Slot &slot = files_[i];
+            if (!slot.done)
+            {
+                ::close(std::exchange(slot.fd, -1));
+                slot.file.contents = read_file(slot.file.path);
+                slot.done = true;
+            }
+        }
+        num_in_flight_ = 0;
+    }
+
+    std::vector<Slot> files_;
+    std::size_t max_in_flight_;
+    std::size_t next_to_open_ = 0;
+    std::size_t next_to_return_ = 0;
+    std::size_t num_in_flight_ = 0;
+    unsigned num_to_submit_ = 0;
+
+    int ring_fd_ = -1;
+    void *sq_ring_ = nullptr;
+    void *cq_ring_ = nullptr;
+    std::size_t sq_ring_size_ = 0;
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+};
+#endif
+
+} // namespace
+
+absl::StatusOr<std::vector<std::string>> expand_input_paths(std::string_view pattern)
+{
+    std::vector<std::string> paths;
+    std::string pattern_string(pattern);
+    std::error_code error;
+    if (std::filesystem::is_directory(pattern_string, error))
+    {
+        // Only the error_code overloads, so an entry that can't be checked or a failure reading the directory ends
+        // the loop with |error| set instead of throwing
+        std::filesystem::directory_iterator it(pattern_string, error);
+        while (!error && it != std::filesystem::directory_iterator())
+        {
+            bool is_regular_file = it->is_regular_file(error);
+            // A dangling symlink or a file removed since it was listed isn't an error, just not a file to read
+            if (error == std::errc::no_such_file_or_directory)
+            {
+                error.clear();
+            }
+            if (is_regular_file)
+            {
+                paths.push_back(it->path().string());
+            }
+            // Incrementing would clear an error from is_regular_file
+            if (!error)
+            {
+                it.increment(error);
+            }
+        }
+        if (error)
+        {
+            return absl::InternalError(absl::StrFormat("unable to list %s: %s", pattern, error.message()));
+        }
+    }
+    else
+    {
+        glob_t matches;
+        int result = ::glob(pattern_string.c_str(), 0, nullptr, &matches);
+        if (result == GLOB_NOMATCH)
+        {
+            return absl::NotFoundError(absl::StrFormat("nothing matches %s", pattern));
+        }
+        if (result != 0)
+        {
+            return absl::InternalError(absl::StrFormat("unable to expand %s", pattern));
+        }
+        paths.assign(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+        ::globfree(&matches);
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+bool is_batch_path(std::string_view path)
+{
+    std::error_code error;
+    return path.find_first_of("*?[") != std::string_view::npos ||
+           std::filesystem::is_directory(std::string(path), error);
+}
+
+std::unique_ptr<BatchReader> BatchReader::create(std::vector<std::string> paths, int max_in_flight)
+{
+#if defined(__linux__)
+    // Keep a copy of the paths in case the ring can't be set up
+    if (auto reader = IoUringBatchReader::create(paths, max_in_flight))
+    {
+        return reader;
+    }
+#endif
+    return std::make_unique<ThreadBatchReader>(std::move(paths), max_in_flight);
+}
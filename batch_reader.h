@@ -0,0 +1,44 @@
+#ifndef BATCH_READER_H_
+#define BATCH_READER_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+// Expands |pattern| into the input files it names: every regular file in it if it's a directory, otherwise the
+// matches of it as a shell glob (e.g. "inputs/day_6/*.txt"). Either way the paths come back sorted.
+absl::StatusOr<std::vector<std::string>> expand_input_paths(std::string_view pattern);
+
+// Returns true if |path| names a batch of inputs (a directory or a glob) rather than a single file.
+bool is_batch_path(std::string_view path);
+
+struct BatchFile
+{
+    std::string path;
+    absl::StatusOr<std::string> contents;
+};
+
+// BatchReader reads a list of files with several reads in flight at once, so the caller can solve one file while
+// the next ones are still being read. Files are handed back in the order they were given, whatever order the reads
+// finish in. When there are lots of small files the time goes into waiting on each open and read rather than
+// copying bytes, which is why this reads into memory instead of mapping every file.
+class BatchReader
+{
+public:
+    // Uses io_uring where the kernel supports it and falls back to a few reader threads otherwise.
+    // |max_in_flight| bounds both the outstanding reads and how many files are buffered ahead of the caller.
+    static std::unique_ptr<BatchReader> create(std::vector<std::string> paths, int max_in_flight);
+
+    virtual ~BatchReader() {}
+
+    // Blocks until the next file is read and moves it into |file|. Returns false once every file has been returned.
+    virtual bool next(BatchFile &file) = 0;
+
+    // "io_uring" or "threads", for diagnostics
+    virtual std::string_view backend() const = 0;
+};
+
+#endif // BATCH_READER_H_
@@ -0,0 +1,73 @@
+#include "benchmark_util.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+#include "input_generators.h"
+#include "input_reader.h"
+
+void apply_record_counts(benchmark::internal::Benchmark *benchmark)
+{
+    int64_t max_records = 10'000'000;
+    if (const char *max_records_env = std::getenv("AOC_BENCHMARK_MAX_RECORDS"))
+    {
+        max_records = std::atoll(max_records_env);
+    }
+    for (int64_t num_records = 1000; num_records <= max_records; num_records *= 10)
+    {
+        benchmark->Arg(num_records);
+    }
+}
+
+const std::string &cached_input(int day, int64_t num_records)
+{
+    static auto *inputs = new std::map<std::pair<int, int64_t>, std::string>();
+    auto [it, inserted] = inputs->try_emplace({day, num_records});
+    if (inserted)
+    {
+        it->second = generate_input_string(day, num_records, /*seed=*/2020);
+    }
+    return it->second;
+}
+
+const std::string &cached_input_file(int day, int64_t num_records)
+{
+    static auto *paths = new std::map<std::pair<int, int64_t>, std::string>();
+    auto [it, inserted] = paths->try_emplace({day, num_records});
+    if (inserted)
+    {
+        it->second = (std::filesystem::temp_directory_path() /
+                      absl::StrFormat("aoc_day_%d_%d_records.txt", day, num_records))
+                         .string();
+        const std::string &contents = cached_input(day, num_records);
+        std::ofstream(it->second, std::ios_base::binary).write(contents.data(), contents.size());
+    }
+    return it->second;
+}
+
+void BM_Read(benchmark::State &state, int day)
+{
+    const std::string &path = cached_input_file(day, state.range(0));
+    for (auto _ : state)
+    {
+        auto input_file = MappedFile::open(path);
+        if (!input_file.ok())
+        {
+            state.SkipWithError(input_file.status().ToString().c_str());
+            break;
+        }
+        std::string_view contents = input_file->contents();
+        uint64_t checksum = 0;
+        for (std::size_t i = 0; i < contents.size(); i += 4096)
+        {
+            checksum += contents[i];
+        }
+        benchmark::DoNotOptimize(checksum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * cached_input(day, state.range(0)).size());
+}
@@ -0,0 +1,27 @@
+#ifndef BENCHMARK_UTIL_H_
+#define BENCHMARK_UTIL_H_
+
+#include <cstdint>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+// Shared setup for the day_*_benchmark binaries. Every benchmark takes the number of records as its argument
+// and times one phase (read, parse or solve) on its own, with the inputs for the other phases prepared outside
+// the timed loop.
+
+// Registers record counts 10^3, 10^4, ... up to $AOC_BENCHMARK_MAX_RECORDS (default 10^7). Use with ->Apply().
+// Bigger sizes are better measured on a file from generate-input, since they won't fit in memory twice.
+void apply_record_counts(benchmark::internal::Benchmark *benchmark);
+
+// Generated input for |day| with |num_records| records. Cached so each size is only generated once per binary.
+const std::string &cached_input(int day, int64_t num_records);
+
+// Same input written to a file in the temp directory, for benchmarking the read phase.
+const std::string &cached_input_file(int day, int64_t num_records);
+
+// Read phase: maps the generated file for |day| and touches every page, since the mapping itself is lazy.
+// Use with BENCHMARK_CAPTURE(BM_Read, day_N, N).
+void BM_Read(benchmark::State &state, int day);
+
+#endif // BENCHMARK_UTIL_H_
@@ -0,0 +1,27 @@
+#include "cpu_dispatch.h"
+
+namespace
+{
+
+SimdLevel detect_simd_level()
+{
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SimdLevel::kAvx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return SimdLevel::kSse2;
+    }
+#endif
+    return SimdLevel::kScalar;
+}
+
+} // namespace
+
+SimdLevel cpu_simd_level()
+{
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
@@ -0,0 +1,37 @@
+#ifndef CPU_DISPATCH_H_
+#define CPU_DISPATCH_H_
+
+// The vectorized modules (letter_count, the day 5 pass decoder and wide_answer_matrix) compile a kernel per
+// instruction set with __attribute__((target(...))) rather than building the whole binary with -mavx2, so it still
+// runs on CPUs without AVX2. pick_simd_kernel() is how each of them chooses which kernel to run.
+
+// The instruction sets there are kernels for, in order of preference
+enum class SimdLevel
+{
+    kScalar,
+    kSse2,
+    kAvx2,
+};
+
+// The widest instruction set this CPU supports. The CPU is only checked on the first call, the kernels are picked
+// on every call and __builtin_cpu_supports would cost more than some of them.
+SimdLevel cpu_simd_level();
+
+// Returns the kernel for cpu_simd_level(). A module without an SSE2 kernel passes its scalar one for |sse2|. Only
+// x86 builds have the SSE2 and AVX2 kernels, other builds use the scalar kernel without calling this.
+template <typename Kernel>
+Kernel pick_simd_kernel(Kernel scalar, Kernel sse2, Kernel avx2)
+{
+    switch (cpu_simd_level())
+    {
+    case SimdLevel::kAvx2:
+        return avx2;
+    case SimdLevel::kSse2:
+        return sse2;
+    case SimdLevel::kScalar:
+        break;
+    }
+    return scalar;
+}
+
+#endif // CPU_DISPATCH_H_
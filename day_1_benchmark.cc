@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "benchmark_util.h"
+#include "day_1_report_repair.h"
+#include "integer_sort.h"
+#include "thread_pool.h"
+
+static void BM_Parse(benchmark::State &state)
+{
+    const std::string &contents = cached_input(1, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(parse_entries(contents));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Sorting is part of solving, the parsed entries come in file order.
+static void BM_Solve(benchmark::State &state, KSumStrategy strategy)
+{
+    const std::vector<int> entries = parse_entries(cached_input(1, state.range(0)));
+    for (auto _ : state)
+    {
+        std::vector<int> sorted_entries = entries;
+        sort_integers(sorted_entries);
+        benchmark::DoNotOptimize(find_k_sum(sorted_entries, 2, 2020, strategy));
+        benchmark::DoNotOptimize(find_k_sum(sorted_entries, 3, 2020, strategy));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// A target no triplet sums to, so the search can never stop early and always does the full O(n^2) walk. The entries
+// are folded into a small non-negative range first so no sum can overflow, which makes a negative target unreachable.
+// Both arms run the same search, a pool of 1 just runs it all on the calling thread.
+static void BM_TripletNoMatch(benchmark::State &state, int num_threads)
+{
+    std::vector<int> sorted_entries = parse_entries(cached_input(1, state.range(0)));
+    for (int &entry : sorted_entries)
+    {
+        entry = std::abs(entry % 1'000'000);
+    }
+    sort_integers(sorted_entries);
+    ThreadPool pool(num_threads);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(find_sum_indices_triplets(sorted_entries, -1, pool));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The generated entries span most of the int range, so this is the radix sort rather than the counting sort.
+static void BM_Sort(benchmark::State &state, bool use_std_sort)
+{
+    const std::vector<int> entries = parse_entries(cached_input(1, state.range(0)));
+    for (auto _ : state)
+    {
+        std::vector<int> sorted_entries = entries;
+        if (use_std_sort)
+        {
+            std::sort(sorted_entries.begin(), sorted_entries.end());
+        }
+        else
+        {
+            sort_integers(sorted_entries);
+        }
+        benchmark::DoNotOptimize(sorted_entries.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_CAPTURE(BM_Read, day_1, 1)->Apply(apply_record_counts);
+BENCHMARK(BM_Parse)->Apply(apply_record_counts);
+BENCHMARK_CAPTURE(BM_Sort, std_sort, true)->Apply(apply_record_counts);
+BENCHMARK_CAPTURE(BM_Sort, integer_sort, false)->Apply(apply_record_counts);
+BENCHMARK_CAPTURE(BM_Solve, auto, KSumStrategy::kAuto)->Apply(apply_record_counts);
+BENCHMARK_CAPTURE(BM_Solve, hash, KSumStrategy::kHash)->Apply(apply_record_counts);
+// Quadratic, so only the small sizes
+BENCHMARK_CAPTURE(BM_TripletNoMatch, serial, 1)->Arg(1000)->Arg(10000);
+BENCHMARK_CAPTURE(BM_TripletNoMatch, all_cores, 0)->Arg(1000)->Arg(10000);
@@ -1,33 +1,82 @@
 // https://adventofcode.com/2020/day/1
+#include "day_1_report_repair.h"
+
 #include <algorithm>
-#include <array>
-#include <exception>
-#include <iostream>
-#include <fstream>
-#include <span>
-#include <string>
-#include <string_view>
-#include <vector>
-
-#include "absl/status/statusor.h"
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
+
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "input_reader.h"
+#include "integer_sort.h"
+
+namespace {
 
-// Find two entries that sum to 2020 then multiply them together
+// Appends the entries of |contents| to |out|, which can be a vector's back inserter or a pointer into a buffer
+// with room for one entry per line. Returns |out| past the last entry.
+template <typename Out>
+Out parse_entries_to(std::string_view contents, Out out) {
+    for_each_line(contents, [&out](std::string_view line) {
+        // from_chars works directly on the mapped bytes, unlike std::stoi which needs a std::string.
+        int value;
+        if (std::from_chars(line.data(), line.data() + line.size(), value).ec == std::errc()) {
+            *out++ = value;
+        }
+    });
+    return out;
+}
 
-std::vector<int> read_file(std::string_view filename) {
+} // namespace
+
+std::vector<int> parse_entries(std::string_view contents) {
     std::vector<int> file_entries;
-    std::ifstream input_file_stream;
-    std::cout << "Opening " << filename << std::endl;
-    input_file_stream.open(std::string(filename), std::ios_base::in);
-    std::string current_line;
-    while (input_file_stream >> current_line) {
-        file_entries.push_back(std::stoi(current_line));
-    }
-    std::cout << "Read " << file_entries.size() << " entries" << std::endl;
+    parse_entries_to(contents, std::back_inserter(file_entries));
     return file_entries;
 }
 
+void parse_entries(std::string_view contents, std::pmr::vector<int> &entries) {
+    entries.clear();
+    parse_entries_to(contents, std::back_inserter(entries));
+}
+
+void parse_sorted_entries(std::string_view contents, ThreadPool &pool, std::pmr::vector<int> &entries) {
+    std::pmr::memory_resource *resource = entries.get_allocator().resource();
+    // A few chunks per thread so a slow chunk can be balanced out by stealing the others
+    std::pmr::vector<std::string_view> chunks =
+        split_into_chunks(contents, pool.num_threads() * 4, RecordBoundary::kNewline, resource);
+    // Each chunk gets a slice of |entries| with room for one entry per line. Everything is allocated here, since
+    // only this thread may use |resource|, and the tasks parse straight into their slice.
+    std::pmr::vector<size_t> offsets(chunks.size() + 1, 0, resource);
+    pool.parallel_for(chunks.size(), [&](size_t i) {
+        offsets[i + 1] = std::count(chunks[i].begin(), chunks[i].end(), '\n') + (chunks[i].back() != '\n');
+    });
+    for (size_t i = 0; i < chunks.size(); i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    entries.clear();
+    entries.resize(offsets.back());
+    std::pmr::vector<size_t> chunk_sizes(chunks.size(), resource);
+    pool.parallel_for(chunks.size(), [&](size_t i) {
+        int *begin = entries.data() + offsets[i];
+        chunk_sizes[i] = parse_entries_to(chunks[i], begin) - begin;
+    });
+    // Close the gaps left by blank or malformed lines. Usually there are none, so nothing moves.
+    size_t num_entries = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (offsets[i] != num_entries) {
+            std::copy_n(entries.begin() + offsets[i], chunk_sizes[i], entries.begin() + num_entries);
+        }
+        num_entries += chunk_sizes[i];
+    }
+    entries.resize(num_entries);
+    sort_integers(entries, pool, resource);
+}
+
 absl::StatusOr<std::pair<int, int>> find_sum_indices_pair(std::span<int> sorted_entries, int sum_value) {
     int min_index = 0;
     int max_index = sorted_entries.size() - 1;
@@ -60,44 +109,317 @@ absl::StatusOr<std::tuple<int, int, int>> find_sum_indices_triplet(std::span<int
     return absl::NotFoundError(absl::StrFormat("no triplet found that sums to provided value (%d)", sum_value));
 }
 
-int main(int argc, char const *argv[])
-{
-    // TODO: Figure out how to make this programattic instead of hardcoding
-    // auto input_filepath = std::filesystem::current_path() / "day_1_input.txt";
-    // std::cout << input_filepath.string() << std::flush;
-    auto file_entries = read_file("/home/drew/workspace/advent-of-code/day_1_input.txt");
-    // Brute force method would be O(n^2) where we compare every single entry with every other entry.
-    // More elegant solution would be sort the entries then keep two indices that move inwards until
-    // we find the sum we want.
-    std::sort(file_entries.begin(), file_entries.end());
-    { // FIRST PART
-        auto index_pair = find_sum_indices_pair({&file_entries[0], file_entries.size()}, 2020);
-        if (!index_pair.ok()) {
-            return -1;
+namespace {
+
+// Don't let the bitset grow past 16MB no matter how many entries there are.
+constexpr int64_t kMaxBitsetRange = int64_t{1} << 27;
+
+class BitsetPresence {
+public:
+    explicit BitsetPresence(std::span<const int> sorted_entries)
+        : min_(sorted_entries.front()),
+          max_(sorted_entries.back()),
+          bits_((max_ - min_) / 64 + 1) {
+        for (int entry : sorted_entries) {
+            int64_t offset = entry - min_;
+            bits_[offset / 64] |= uint64_t{1} << (offset % 64);
+        }
+    }
+
+    bool contains(int64_t value) const {
+        if (value < min_ || value > max_) {
+            return false;
         }
-        const auto& [first_index, second_index] = *index_pair;
-        auto first_value = file_entries[first_index];
-        auto second_value = file_entries[second_index];
-        std::cout << first_value << " + " << second_value << " = 2020" << std::endl;
-        std::cout << first_value << " * " << second_value << " = " << first_value * second_value << std::endl;
+        int64_t offset = value - min_;
+        return (bits_[offset / 64] >> (offset % 64)) & 1;
     }
 
-    { // SECOND PART
-        auto index_triplet = find_sum_indices_triplet({&file_entries[0], file_entries.size()}, 2020);
-        if (!index_triplet.ok()) {
-            return -1;
+private:
+    int64_t min_;
+    int64_t max_;
+    std::vector<uint64_t> bits_;
+};
+
+class HashPresence {
+public:
+    explicit HashPresence(std::span<const int> sorted_entries)
+        : entries_(sorted_entries.begin(), sorted_entries.end()) {}
+
+    bool contains(int64_t value) const {
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+            return false;
         }
-        const auto& [first_index, second_index, third_index] = *index_triplet;
-        auto first_value = file_entries[first_index];
-        auto second_value = file_entries[second_index];
-        auto third_value = file_entries[third_index];
-        std::cout << first_value << " + " << second_value << " + " << third_value << " = 2020" << std::endl;
-        std::cout << first_value << " * " << second_value << " * " << third_value << " = " << first_value * second_value * third_value << std::endl;
+        return entries_.contains(static_cast<int>(value));
     }
 
-    return 0;
+private:
+    absl::flat_hash_set<int> entries_;
+};
+
+// Picks |remaining| entries from |sorted_entries| starting at |start| (so that every combination is only
+// visited once, in ascending order) that sum to |target|. The final entry is found with a lookup in
+// |presence| instead of another loop, which takes a factor of n off the brute force search.
+// |cancelled| (nullable) is checked before every entry at every level, so a parallel search can be stopped early.
+template <typename Presence>
+bool search_k_sum(std::span<const int> sorted_entries, const Presence &presence, int remaining, int64_t target,
+                  size_t start, std::vector<int> &chosen, const std::atomic<bool> *cancelled = nullptr) {
+    if (remaining == 1) {
+        // Only reachable when k == 1 to begin with
+        if (!presence.contains(target)) {
+            return false;
+        }
+        chosen.push_back(target);
+        return true;
+    }
+    const int64_t max_entry = sorted_entries.back();
+    for (size_t i = start; i < sorted_entries.size(); i++) {
+        if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        int64_t value = sorted_entries[i];
+        // Picking the same value again at this depth can only find a subset of what the first one did
+        if (i > start && value == sorted_entries[i - 1]) {
+            continue;
+        }
+        // Everything after |i| is >= |value| so if |remaining| copies of |value| overshoot, so does the rest.
+        if (value * remaining > target) {
+            break;
+        }
+        // And if even the largest entries can't make up the difference, try a bigger |value|.
+        if (value + max_entry * (remaining - 1) < target) {
+            continue;
+        }
+        int64_t rest = target - value;
+        if (remaining == 2) {
+            // |rest| >= |value| because of the check above. If it is bigger it has to come after |i|, if it is
+            // equal we need a second copy of |value|.
+            bool found = rest == value ? (i + 1 < sorted_entries.size() && sorted_entries[i + 1] == value)
+                                       : presence.contains(rest);
+            if (found) {
+                chosen.push_back(value);
+                chosen.push_back(rest);
+                return true;
+            }
+            continue;
+        }
+        chosen.push_back(value);
+        if (search_k_sum(sorted_entries, presence, remaining - 1, rest, i + 1, chosen, cancelled)) {
+            return true;
+        }
+        chosen.pop_back();
+    }
+    return false;
 }
 
+// Stripes are dealt out round robin rather than as contiguous ranges, since the anchors at the front of a sorted
+// ledger have far more candidates after them than the ones at the back. A few per thread evens out the rest.
+constexpr size_t kStripesPerThread = 8;
 
+size_t num_stripes(size_t num_entries, ThreadPool &pool) {
+    return std::max<size_t>(1, std::min(num_entries, static_cast<size_t>(pool.num_threads()) * kStripesPerThread));
+}
+
+// search_k_sum with the first of the |k| entries picked on |pool|
+template <typename Presence>
+bool search_k_sum_parallel(std::span<const int> sorted_entries, const Presence &presence, int k, int64_t target,
+                           ThreadPool &pool, std::vector<int> &chosen) {
+    const int64_t max_entry = sorted_entries.back();
+    const size_t stripes = num_stripes(sorted_entries.size(), pool);
+    std::atomic<bool> found = false;
+    std::mutex chosen_mutex;
+    pool.parallel_for(stripes, [&](size_t stripe) {
+        std::vector<int> stripe_chosen;
+        for (size_t i = stripe; i < sorted_entries.size(); i += stripes) {
+            if (found.load(std::memory_order_relaxed)) {
+                return;
+            }
+            // The same pruning as the first level of search_k_sum
+            int64_t value = sorted_entries[i];
+            if (i > 0 && value == sorted_entries[i - 1]) {
+                continue;
+            }
+            if (value * k > target) {
+                return;
+            }
+            if (value + max_entry * (k - 1) < target) {
+                continue;
+            }
+            stripe_chosen.assign(1, static_cast<int>(value));
+            if (search_k_sum(sorted_entries, presence, k - 1, target - value, i + 1, stripe_chosen, &found)) {
+                std::lock_guard<std::mutex> lock(chosen_mutex);
+                if (!found.exchange(true, std::memory_order_relaxed)) {
+                    chosen = std::move(stripe_chosen);
+                }
+                return;
+            }
+        }
+    });
+    return found.load();
+}
 
+using Triplet = std::tuple<size_t, size_t, size_t>;
 
+// Finds the pairs j < k after |anchor| with sorted_entries[j] + sorted_entries[k] == |target| and appends them to
+// |triplets| with the anchor. Returns true if it found any. With SumMatches::kFirst it stops at the first one,
+// otherwise a run of equal entries on either side pairs up every way it can.
+bool find_anchored_pairs(std::span<const int> sorted_entries, size_t anchor, int64_t target, SumMatches matches,
+                         std::vector<Triplet> &triplets) {
+    if (sorted_entries.size() - anchor < 3) {
+        return false;
+    }
+    size_t low = anchor + 1;
+    size_t high = sorted_entries.size() - 1;
+    bool found = false;
+    while (low < high) {
+        int64_t sum = int64_t{sorted_entries[low]} + sorted_entries[high];
+        if (sum < target) {
+            low++;
+        } else if (sum > target) {
+            high--;
+        } else if (matches == SumMatches::kFirst) {
+            triplets.emplace_back(anchor, low, high);
+            return true;
+        } else if (sorted_entries[low] == sorted_entries[high]) {
+            // Everything from |low| to |high| is the same value, any two of them make the sum
+            for (size_t j = low; j < high; j++) {
+                for (size_t k = j + 1; k <= high; k++) {
+                    triplets.emplace_back(anchor, j, k);
+                }
+            }
+            return true;
+        } else {
+            size_t low_end = low;
+            while (sorted_entries[low_end] == sorted_entries[low]) {
+                low_end++;
+            }
+            size_t high_begin = high;
+            while (sorted_entries[high_begin] == sorted_entries[high]) {
+                high_begin--;
+            }
+            for (size_t j = low; j < low_end; j++) {
+                for (size_t k = high_begin + 1; k <= high; k++) {
+                    triplets.emplace_back(anchor, j, k);
+                }
+            }
+            found = true;
+            low = low_end;
+            high = high_begin;
+        }
+    }
+    return found;
+}
+
+// Sorts a copy of |entries| into |sorted_copy| if they aren't sorted already, and returns the sorted entries.
+std::span<const int> sorted_entries_of(std::span<const int> entries, std::vector<int> &sorted_copy) {
+    if (std::is_sorted(entries.begin(), entries.end())) {
+        return entries;
+    }
+    sorted_copy.assign(entries.begin(), entries.end());
+    sort_integers(sorted_copy);
+    return sorted_copy;
+}
+
+// Maps the chosen values back to indices in the caller's order, making sure duplicates get distinct indices.
+std::vector<size_t> indices_of_values(std::span<const int> entries, const std::vector<int> &values) {
+    std::vector<size_t> indices;
+    for (int value : values) {
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i] == value && std::find(indices.begin(), indices.end(), i) == indices.end()) {
+                indices.push_back(i);
+                break;
+            }
+        }
+    }
+    return indices;
+}
+
+} // namespace
+
+absl::StatusOr<std::vector<std::tuple<size_t, size_t, size_t>>> find_sum_indices_triplets(
+    std::span<const int> sorted_entries, int sum_value, ThreadPool &pool, SumMatches matches) {
+    const size_t stripes = num_stripes(sorted_entries.size(), pool);
+    std::vector<std::vector<Triplet>> stripe_triplets(stripes);
+    std::atomic<bool> found = false;
+    pool.parallel_for(stripes, [&](size_t stripe) {
+        for (size_t anchor = stripe; anchor < sorted_entries.size(); anchor += stripes) {
+            // Checked once per anchor, each of which is at most a linear scan
+            if (matches == SumMatches::kFirst && found.load(std::memory_order_relaxed)) {
+                return;
+            }
+            if (find_anchored_pairs(sorted_entries, anchor, int64_t{sum_value} - sorted_entries[anchor], matches,
+                                    stripe_triplets[stripe])) {
+                found.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+    std::vector<Triplet> triplets;
+    for (std::vector<Triplet> &stripe : stripe_triplets) {
+        triplets.insert(triplets.end(), stripe.begin(), stripe.end());
+    }
+    if (triplets.empty()) {
+        return absl::NotFoundError(absl::StrFormat("no triplet found that sums to provided value (%d)", sum_value));
+    }
+    if (matches == SumMatches::kFirst) {
+        // More than one worker may have found one before they saw the flag
+        triplets.resize(1);
+    } else {
+        std::sort(triplets.begin(), triplets.end());
+    }
+    return triplets;
+}
+
+// The bitset wins whenever it isn't much bigger than the input itself, i.e. about one word per entry.
+KSumStrategy choose_k_sum_strategy(std::span<const int> sorted_entries) {
+    if (sorted_entries.empty()) {
+        return KSumStrategy::kHash;
+    }
+    int64_t range = int64_t{sorted_entries.back()} - sorted_entries.front() + 1;
+    if (range <= kMaxBitsetRange && range <= 64 * static_cast<int64_t>(sorted_entries.size())) {
+        return KSumStrategy::kBitset;
+    }
+    return KSumStrategy::kHash;
+}
+
+absl::StatusOr<std::vector<size_t>> find_k_sum(std::span<const int> entries, int k, int target,
+                                               KSumStrategy strategy) {
+    if (k <= 0 || static_cast<size_t>(k) > entries.size()) {
+        return absl::InvalidArgumentError(absl::StrFormat("can't pick %d of %d entries", k, entries.size()));
+    }
+    std::vector<int> sorted_copy;
+    std::span<const int> sorted_entries = sorted_entries_of(entries, sorted_copy);
+    if (strategy == KSumStrategy::kAuto) {
+        strategy = choose_k_sum_strategy(sorted_entries);
+    }
+    std::vector<int> values;
+    bool found = strategy == KSumStrategy::kBitset
+                     ? search_k_sum(sorted_entries, BitsetPresence(sorted_entries), k, target, 0, values)
+                     : search_k_sum(sorted_entries, HashPresence(sorted_entries), k, target, 0, values);
+    if (!found) {
+        return absl::NotFoundError(absl::StrFormat("no %d entries found that sum to provided value (%d)", k, target));
+    }
+    return indices_of_values(entries, values);
+}
+
+absl::StatusOr<std::vector<size_t>> find_k_sum(std::span<const int> entries, int k, int target, ThreadPool &pool,
+                                               KSumStrategy strategy) {
+    // A pair is a single scan with a lookup per entry, not worth splitting
+    if (k <= 2 || pool.num_threads() == 1) {
+        return find_k_sum(entries, k, target, strategy);
+    }
+    if (static_cast<size_t>(k) > entries.size()) {
+        return absl::InvalidArgumentError(absl::StrFormat("can't pick %d of %d entries", k, entries.size()));
+    }
+    std::vector<int> sorted_copy;
+    std::span<const int> sorted_entries = sorted_entries_of(entries, sorted_copy);
+    if (strategy == KSumStrategy::kAuto) {
+        strategy = choose_k_sum_strategy(sorted_entries);
+    }
+    std::vector<int> values;
+    bool found = strategy == KSumStrategy::kBitset
+                     ? search_k_sum_parallel(sorted_entries, BitsetPresence(sorted_entries), k, target, pool, values)
+                     : search_k_sum_parallel(sorted_entries, HashPresence(sorted_entries), k, target, pool, values);
+    if (!found) {
+        return absl::NotFoundError(absl::StrFormat("no %d entries found that sum to provided value (%d)", k, target));
+    }
+    return indices_of_values(entries, values);
+}
@@ -0,0 +1,158 @@
+// https://adventofcode.com/2020/day/1
+#ifndef DAY_1_REPORT_REPAIR_H_
+#define DAY_1_REPORT_REPAIR_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+// Find two entries that sum to 2020 then multiply them together
+constexpr int kEntrySumTarget = 2020;
+
+// Parses one integer per line. |contents| is the raw input file.
+std::vector<int> parse_entries(std::string_view contents);
+// Same, but reuses |entries|' allocation, e.g. a vector in the runner's per-job arena. Anything already in
+// |entries| is cleared first.
+void parse_entries(std::string_view contents, std::pmr::vector<int> &entries);
+
+// Parallel version of parse_entries that also sorts, replacing whatever is in |entries|. The chunks of |contents|
+// are parsed on |pool| straight into their own slices of |entries|, then the entries are radix sorted with the
+// passes split over |pool| as well. Scratch space comes from |entries|' memory resource.
+void parse_sorted_entries(std::string_view contents, ThreadPool &pool, std::pmr::vector<int> &entries);
+
+absl::StatusOr<std::pair<int, int>> find_sum_indices_pair(std::span<int> sorted_entries, int sum_value);
+
+absl::StatusOr<std::tuple<int, int, int>> find_sum_indices_triplet(std::span<int> sorted_entries, int sum_value);
+
+// Which lookup find_k_sum uses to find the last entry of a combination once the first k - 1 are picked.
+enum class KSumStrategy {
+    kAuto,
+    // One bit per value between the min and max entry. Lookups are a single load but the memory is
+    // proportional to the value range, so this only makes sense for narrow ranges.
+    kBitset,
+    // Hash set of the entries. Memory is proportional to the number of entries regardless of their range.
+    kHash,
+};
+
+// Whether a search stops at the first match or collects every one
+enum class SumMatches {
+    kFirst,
+    kAll,
+};
+
+// Parallel version of find_sum_indices_triplet for large ledgers. The anchors (the smallest entry of each triplet)
+// are dealt out round robin over |pool|, and each anchor runs the pair search on the entries after it. With kFirst the
+// workers share a flag and all of them stop as soon as one finds a triplet, so if there are several, which one comes
+// back depends on timing. With kAll every triplet of distinct indices i < j < k is returned, sorted. Unlike
+// find_sum_indices_triplet an entry is never paired with itself. Returns NotFound if there is no triplet.
+absl::StatusOr<std::vector<std::tuple<size_t, size_t, size_t>>> find_sum_indices_triplets(
+    std::span<const int> sorted_entries, int sum_value, ThreadPool &pool, SumMatches matches = SumMatches::kFirst);
+
+// Picks the KSumStrategy for |sorted_entries| based on their value range and how many there are.
+KSumStrategy choose_k_sum_strategy(std::span<const int> sorted_entries);
+
+// Finds |k| entries (at distinct indices) that sum to |target| and returns their indices into |entries|.
+// |entries| doesn't need to be sorted, but a sorted copy is made if it isn't.
+absl::StatusOr<std::vector<size_t>> find_k_sum(std::span<const int> entries, int k, int target,
+                                               KSumStrategy strategy = KSumStrategy::kAuto);
+// Same, but the first entry of the combination is picked in parallel on |pool|. The workers share a cancellation flag
+// that the search checks at every level, so they all stop once one of them finds a combination.
+absl::StatusOr<std::vector<size_t>> find_k_sum(std::span<const int> entries, int k, int target, ThreadPool &pool,
+                                               KSumStrategy strategy = KSumStrategy::kAuto);
+
+// Compile-time versions of the parse and search, e.g. to solve an input embedded with embedded_input(). The search
+// is the same as find_sum_indices_pair/triplet but reports a miss with std::nullopt since a status isn't constexpr.
+
+// Parses a line the way parse_entries does (leading digits, optionally negative), or std::nullopt if there are none.
+constexpr std::optional<int> parse_entry(std::string_view line) {
+    bool negative = !line.empty() && line[0] == '-';
+    size_t pos = negative ? 1 : 0;
+    if (pos == line.size() || line[pos] < '0' || line[pos] > '9') {
+        return std::nullopt;
+    }
+    int value = 0;
+    for (; pos < line.size() && line[pos] >= '0' && line[pos] <= '9'; pos++) {
+        value = value * 10 + (line[pos] - '0');
+    }
+    return negative ? -value : value;
+}
+
+// The number of entries in |contents|, to size the array for parse_sorted_entry_array
+constexpr size_t count_entries(std::string_view contents) {
+    size_t num_entries = 0;
+    for_each_line(contents, [&num_entries](std::string_view line) { num_entries += parse_entry(line).has_value(); });
+    return num_entries;
+}
+
+template <size_t NumEntries>
+constexpr std::array<int, NumEntries> parse_sorted_entry_array(std::string_view contents) {
+    std::array<int, NumEntries> entries{};
+    size_t num_entries = 0;
+    for_each_line(contents, [&](std::string_view line) {
+        if (auto value = parse_entry(line); value.has_value() && num_entries < NumEntries) {
+            entries[num_entries++] = *value;
+        }
+    });
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+constexpr std::optional<std::pair<size_t, size_t>> find_sum_pair(std::span<const int> sorted_entries, int sum_value) {
+    if (sorted_entries.empty()) {
+        return std::nullopt;
+    }
+    size_t min_index = 0;
+    size_t max_index = sorted_entries.size() - 1;
+    while (min_index != max_index) {
+        int sum = sorted_entries[min_index] + sorted_entries[max_index];
+        if (sum == sum_value) {
+            return std::make_pair(min_index, max_index);
+        } else if (sum > sum_value) {
+            max_index--;
+        } else {
+            min_index++;
+        }
+    }
+    return std::nullopt;
+}
+
+// |Target| is a template parameter so the comparisons against it fold into the search loop.
+template <int Target>
+constexpr std::optional<int64_t> pair_product(std::span<const int> sorted_entries) {
+    auto pair = find_sum_pair(sorted_entries, Target);
+    if (!pair.has_value()) {
+        return std::nullopt;
+    }
+    return int64_t{sorted_entries[pair->first]} * sorted_entries[pair->second];
+}
+
+template <int Target>
+constexpr std::optional<int64_t> triplet_product(std::span<const int> sorted_entries) {
+    for (size_t i = 0; i < sorted_entries.size(); i++) {
+        // The pair is searched after |i| so entry |i| can't be used twice, which makes its indices relative to |i| + 1
+        auto pair = find_sum_pair(sorted_entries.subspan(i + 1), Target - sorted_entries[i]);
+        if (pair.has_value()) {
+            return int64_t{sorted_entries[i]} * sorted_entries[pair->first + i + 1] *
+                   sorted_entries[pair->second + i + 1];
+        }
+    }
+    return std::nullopt;
+}
+
+// 500 + 500 + 1020 is only a triplet if entry 500 could be used twice
+static_assert(!triplet_product<2020>(std::array{5, 6, 7, 500, 1020}).has_value());
+static_assert(triplet_product<2020>(std::array{5, 6, 7, 500, 510, 1010}) == int64_t{500} * 510 * 1010);
+
+#endif // DAY_1_REPORT_REPAIR_H_
@@ -0,0 +1,79 @@
+// https://adventofcode.com/2020/day/1
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "day_1_report_repair.h"
+#include "input_reader.h"
+#include "integer_sort.h"
+#include "thread_pool.h"
+
+ABSL_FLAG(int, threads, 1, "Threads to parse, sort and search with, 0 for one per core");
+ABSL_FLAG(bool, all_triplets, false, "Print every triplet that sums to the target instead of solving both parts");
+ABSL_FLAG(std::string, input, "/home/drew/workspace/advent-of-code/day_1_input.txt", "Input file to solve");
+
+int main(int argc, char *argv[])
+{
+    absl::ParseCommandLine(argc, argv);
+    std::string filename = absl::GetFlag(FLAGS_input);
+    std::cout << "Opening " << filename << std::endl;
+    auto input_file = MappedFile::open(filename);
+    if (!input_file.ok()) {
+        std::cerr << input_file.status() << std::endl;
+        return -1;
+    }
+    // Brute force method would be O(n^2) where we compare every single entry with every other entry.
+    // More elegant solution would be sort the entries then keep two indices that move inwards until
+    // we find the sum we want. The entries are ints so they can be sorted in linear time.
+    std::pmr::vector<int> file_entries;
+    ThreadPool pool(absl::GetFlag(FLAGS_threads));
+    if (pool.num_threads() == 1) {
+        parse_entries(input_file->contents(), file_entries);
+        sort_integers(file_entries);
+    } else {
+        parse_sorted_entries(input_file->contents(), pool, file_entries);
+    }
+    std::cout << "Read " << file_entries.size() << " entries" << std::endl;
+    if (absl::GetFlag(FLAGS_all_triplets)) {
+        auto triplets = find_sum_indices_triplets(file_entries, kEntrySumTarget, pool, SumMatches::kAll);
+        if (!triplets.ok()) {
+            std::cerr << triplets.status() << std::endl;
+            return -1;
+        }
+        for (const auto &[i, j, k] : *triplets) {
+            std::cout << file_entries[i] << " + " << file_entries[j] << " + " << file_entries[k] << " = "
+                      << kEntrySumTarget << std::endl;
+        }
+        std::cout << triplets->size() << " triplets" << std::endl;
+        return 0;
+    }
+    // FIRST PART is a pair, SECOND PART is a triplet
+    for (int k : {2, 3}) {
+        auto indices = find_k_sum(file_entries, k, kEntrySumTarget, pool);
+        if (!indices.ok()) {
+            std::cerr << indices.status() << std::endl;
+            return -1;
+        }
+        int64_t product = 1;
+        for (size_t i = 0; i < indices->size(); i++) {
+            std::cout << (i == 0 ? "" : " + ") << file_entries[(*indices)[i]];
+            product *= file_entries[(*indices)[i]];
+        }
+        std::cout << " = " << kEntrySumTarget << std::endl;
+        for (size_t i = 0; i < indices->size(); i++) {
+            std::cout << (i == 0 ? "" : " * ") << file_entries[(*indices)[i]];
+        }
+        std::cout << " = " << product << std::endl;
+    }
+
+    return 0;
+}
+
+
+
+
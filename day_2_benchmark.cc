@@ -0,0 +1,82 @@
+#include "benchmark/benchmark.h"
+#include "benchmark_util.h"
+#include "day_2_password_philosophy.h"
+#include "input_reader.h"
+
+static void BM_Parse(benchmark::State &state)
+{
+    const std::string &contents = cached_input(2, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(parse_password_batch(contents));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Policy>
+static void BM_Solve(benchmark::State &state)
+{
+    const PasswordBatch batch = parse_password_batch(cached_input(2, state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(count_valid_passwords<Policy>(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The generated input with a run of blank lines after every 64th line. Blank lines parse to empty passwords, which
+// the packed old policy kernel fits into a register without using any of its bytes, so a run of them is the most
+// texts it ever packs at once.
+static void BM_SolveBlankLines(benchmark::State &state)
+{
+    constexpr int kLinesBetweenRuns = 64;
+    constexpr int kBlankLinesPerRun = 100;
+    std::string contents;
+    int line = 0;
+    for_each_line(cached_input(2, state.range(0)), [&](std::string_view pw_line)
+    {
+        contents.append(pw_line).push_back('\n');
+        if (++line % kLinesBetweenRuns == 0)
+        {
+            contents.append(kBlankLinesPerRun, '\n');
+        }
+    });
+    const PasswordBatch batch = parse_password_batch(contents);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(count_valid_passwords<OldPasswordPolicy>(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * batch.size());
+}
+
+// The original per-line polymorphic checkers, to compare against the batch path
+template <typename Policy>
+static void BM_SolveVirtual(benchmark::State &state)
+{
+    auto entries = parse_password_checkers(cached_input(2, state.range(0)), &Policy::create_policy);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(count_valid_passwords(entries));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Parses and checks both policies in one pass, compare against BM_Parse plus both BM_Solve
+static void BM_Scan(benchmark::State &state)
+{
+    const std::string &contents = cached_input(2, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scan_valid_passwords(contents));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_CAPTURE(BM_Read, day_2, 2)->Apply(apply_record_counts);
+BENCHMARK(BM_Parse)->Apply(apply_record_counts);
+BENCHMARK_TEMPLATE(BM_Solve, OldPasswordPolicy)->Apply(apply_record_counts);
+BENCHMARK_TEMPLATE(BM_Solve, NewPasswordPolicy)->Apply(apply_record_counts);
+BENCHMARK(BM_SolveBlankLines)->Apply(apply_record_counts);
+BENCHMARK_TEMPLATE(BM_SolveVirtual, OldPasswordPolicy)->Apply(apply_record_counts);
+BENCHMARK_TEMPLATE(BM_SolveVirtual, NewPasswordPolicy)->Apply(apply_record_counts);
+BENCHMARK(BM_Scan)->Apply(apply_record_counts);
@@ -1,77 +1,72 @@
-#include <iostream>
-#include <fstream>
-#include <functional>
-#include <memory>
-#include <span>
-#include <string_view>
-#include <vector>
+#include "day_2_password_philosophy.h"
 
-#include "absl/strings/str_split.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <string>
 
-class PasswordPolicy
-{
-public:
-    virtual bool check_password(std::string_view pw) const = 0;
-    virtual ~PasswordPolicy(){};
-};
+#include "input_reader.h"
+#include "letter_count.h"
 
-class PasswordChecker
+PolicyFields parse_policy_fields(std::string_view pw_policy_string)
 {
-public:
-    explicit PasswordChecker(std::unique_ptr<PasswordPolicy> policy) : policy_(std::move(policy)){};
-    bool check_password(std::string_view pw) const
+    // PasswordPolicy is of the format "N-M l" where N is min, M is max and l is the letter. AFAICT they are all
+    // single characters but this implentation allows for the digits to at least be > 1 digit
+
+    // This runs for every line, so rather than splitting into vectors of strings and calling std::stoi the numbers
+    // are read in place with from_chars, which never allocates.
+    const char *end = pw_policy_string.data() + pw_policy_string.size();
+    PolicyFields fields{/*first=*/0, /*second=*/0, /*letter=*/'\0'};
+    auto [dash, first_ec] = std::from_chars(pw_policy_string.data(), end, fields.first);
+    if (first_ec != std::errc() || dash == end || *dash != '-')
     {
-        return policy_->check_password(pw);
+        return fields;
     }
+    auto [space, second_ec] = std::from_chars(dash + 1, end, fields.second);
+    // The letter follows the space, which should be the last character
+    if (second_ec == std::errc() && end - space >= 2)
+    {
+        fields.letter = space[1];
+    }
+    return fields;
+}
 
-private:
-    std::unique_ptr<PasswordPolicy> policy_;
-};
-
-// OldPasswordPolicy encapsulates the corporate password policy which specifies
-// the min and max amount of a given letter.
-class OldPasswordPolicy : public PasswordPolicy
+std::unique_ptr<OldPasswordPolicy> OldPasswordPolicy::create_policy(std::string_view pw_policy_string)
 {
-public:
-    bool check_password(std::string_view pw) const override;
-    static std::unique_ptr<OldPasswordPolicy> create_policy(std::string_view pw_policy_string);
+    PolicyFields fields = parse_policy_fields(pw_policy_string);
+    return std::unique_ptr<OldPasswordPolicy>(new OldPasswordPolicy(
+        /*min=*/fields.first,
+        /*max=*/fields.second,
+        fields.letter));
+}
 
-private:
-    OldPasswordPolicy(int min, int max, char letter) : min_(min), max_(max), letter_(letter){};
-    int min_;
-    int max_;
-    char letter_;
-};
+bool OldPasswordPolicy::check(int min, int max, char letter, std::string_view pw)
+{
+    int letter_count = count_letter(pw, letter);
+    return letter_count >= min && letter_count <= max;
+}
 
-std::unique_ptr<OldPasswordPolicy> OldPasswordPolicy::create_policy(std::string_view pw_policy_string)
+std::unique_ptr<NewPasswordPolicy> NewPasswordPolicy::create_policy(std::string_view pw_policy_string)
 {
-    // PasswordPolicy is of the format "N-M l" where N is min, M is max and l is the letter. AFAICT they are all
-    // single characters but this implentation allows for the digits to at least be > 1 digit
+    PolicyFields fields = parse_policy_fields(pw_policy_string);
+    return std::unique_ptr<NewPasswordPolicy>(new NewPasswordPolicy(
+        /*first_pos=*/fields.first - 1,
+        /*second_pos=*/fields.second - 1,
+        fields.letter));
+}
 
-    // First, split the min-max from the letter
-    std::vector<std::string_view> first_split = absl::StrSplit(pw_policy_string, " ");
-    // Second half of the split, should only have one character which is the letter that must be found
-    char letter = first_split[1][0];
-    // Second, split the min-max to get them separately
-    std::vector<std::string> second_split = absl::StrSplit(first_split[0], "-");
-    return std::unique_ptr<OldPasswordPolicy>(new OldPasswordPolicy(
-        /*min=*/std::stoi(second_split[0]),
-        /*max=*/std::stoi(second_split[1]),
-        letter));
+bool NewPasswordPolicy::check_password(std::string_view pw) const
+{
+    return check(first_pos_ + 1, second_pos_ + 1, letter_, pw);
 }
 
-bool OldPasswordPolicy::check_password(std::string_view pw) const
+bool NewPasswordPolicy::check(int first, int second, char letter, std::string_view pw)
 {
-    // std::cout << pw << std::endl;
-    int letter_count = 0;
-    for (char letter : pw)
-    {
-        if (letter == letter_)
-        {
-            letter_count++;
-        }
-    }
-    return letter_count >= min_ && letter_count <= max_;
+    std::size_t first_pos = first - 1;
+    std::size_t second_pos = second - 1;
+    // Use XOR so that it returns true IFF one of the positions have the specified letter
+    return (first_pos < pw.size() && pw[first_pos] == letter) ^ (second_pos < pw.size() && pw[second_pos] == letter);
 }
 
 void remove_trailing_whitespace(std::string_view &s)
@@ -90,28 +85,16 @@ void remove_leading_whitespace(std::string_view &s)
     s.remove_prefix(leading_whitespace_pos == std::string::npos ? 0 : leading_whitespace_pos);
 }
 
-template <typename PasswordPolicyFactoryFunction>
-std::vector<std::tuple<PasswordChecker, std::string>> read_file(std::string_view filename, PasswordPolicyFactoryFunction create_policy_fn)
+void split_policy_and_password(std::string_view line, std::string_view &policy, std::string_view &pw)
 {
-    std::vector<std::tuple<PasswordChecker, std::string>> entries;
-    std::ifstream input_file_stream;
-    std::cout << "Opening " << filename << std::endl;
-    input_file_stream.open(std::string(filename), std::ios_base::in);
-    std::string current_line;
-    while (getline(input_file_stream, current_line))
-    {
-        std::vector<std::string_view> policy_and_pw = absl::StrSplit(current_line, ":");
-        std::string_view pw = policy_and_pw[1];
-        remove_leading_whitespace(pw);
-        remove_trailing_whitespace(pw);
-        PasswordChecker checker(std::unique_ptr<PasswordPolicy>(create_policy_fn(policy_and_pw[0]).release()));
-        entries.push_back(std::make_tuple(std::move(checker), std::string(pw)));
-    }
-    std::cout << "Read " << entries.size() << " entries" << std::endl;
-    return entries;
+    std::size_t colon_pos = line.find(':');
+    policy = line.substr(0, colon_pos);
+    pw = colon_pos == std::string_view::npos ? std::string_view() : line.substr(colon_pos + 1);
+    remove_leading_whitespace(pw);
+    remove_trailing_whitespace(pw);
 }
 
-int count_valid_passwords(std::span<std::tuple<PasswordChecker, std::string>> pw_and_policies)
+int count_valid_passwords(std::span<std::tuple<PasswordChecker, std::string_view>> pw_and_policies)
 {
     int valid_passwords = 0;
     for (const auto &[pw_checker, pw] : pw_and_policies)
@@ -124,56 +107,128 @@ int count_valid_passwords(std::span<std::tuple<PasswordChecker, std::string>> pw
     return valid_passwords;
 }
 
-// NewPasswordPolicy encapsulates the corporate password policy which specifies
-// the first and second position where a given letter must be in ONLY one of those positions.
-class NewPasswordPolicy : public PasswordPolicy
+PasswordBatch parse_password_batch(std::string_view contents, std::pmr::memory_resource *resource)
 {
-public:
-    bool check_password(std::string_view pw) const override;
-    static std::unique_ptr<NewPasswordPolicy> create_policy(std::string_view pw_policy_string);
-
-private:
-    NewPasswordPolicy(int first_pos, int second_pos, char letter) : first_pos_(first_pos), second_pos_(second_pos), letter_(letter){};
-    int first_pos_;
-    int second_pos_;
-    char letter_;
-};
+    PasswordBatch batch(resource);
+    // Size the columns up front so they are allocated once instead of growing, which matters most with a monotonic
+    // resource that can't reuse the memory of the smaller arrays.
+    batch.reserve(std::count(contents.begin(), contents.end(), '\n') + 1);
+    for_each_line(contents, [&batch](std::string_view current_line)
+    {
+        std::string_view policy;
+        std::string_view pw;
+        split_policy_and_password(current_line, policy, pw);
+        batch.add(parse_policy_fields(policy), pw);
+    });
+    return batch;
+}
 
-std::unique_ptr<NewPasswordPolicy> NewPasswordPolicy::create_policy(std::string_view pw_policy_string)
+// Most passwords are only a handful of characters, so rather than counting one password at a time the old policy
+// counts a block of them at once with the packed kernel, which fits several passwords in each vector compare.
+template <>
+int count_valid_passwords<OldPasswordPolicy>(const PasswordBatch &batch)
 {
-    // PasswordPolicy is of the format "N-M l" where N is min, M is max and l is the letter. AFAICT they are all
-    // single characters but this implentation allows for the digits to at least be > 1 digit
-
-    // First, split the min-max from the letter
-    std::vector<std::string_view> first_split = absl::StrSplit(pw_policy_string, " ");
-    // Second half of the split, should only have one character which is the letter that must be found
-    char letter = first_split[1][0];
-    // Second, split the min-max to get them separately
-    std::vector<std::string> second_split = absl::StrSplit(first_split[0], "-");
-    return std::unique_ptr<NewPasswordPolicy>(new NewPasswordPolicy(
-        /*first_pos=*/std::stoi(second_split[0]) - 1,
-        /*second_pos=*/std::stoi(second_split[1]) - 1,
-        letter));
+    constexpr std::size_t kBlockSize = 256;
+    std::array<int, kBlockSize> letter_counts;
+    int valid_passwords = 0;
+    for (std::size_t block_start = 0; block_start < batch.size(); block_start += kBlockSize)
+    {
+        std::size_t block_size = std::min(kBlockSize, batch.size() - block_start);
+        count_letters_packed(std::span(batch.password).subspan(block_start, block_size),
+                             std::span(batch.letter).subspan(block_start, block_size),
+                             std::span(letter_counts).first(block_size));
+        for (std::size_t i = 0; i < block_size; i++)
+        {
+            int letter_count = letter_counts[i];
+            valid_passwords += letter_count >= batch.first[block_start + i] && letter_count <= batch.second[block_start + i];
+        }
+    }
+    return valid_passwords;
 }
 
-bool NewPasswordPolicy::check_password(std::string_view pw) const
+ValidPasswordCounts scan_valid_passwords(std::string_view contents)
 {
-    // Use XOR so that it returns true IFF one of the positions have the specified letter
-    return (first_pos_ < pw.size() && pw[first_pos_] == letter_) ^ (second_pos_ < pw.size() && pw[second_pos_] == letter_);
+    ValidPasswordCounts counts;
+    const char *cur = contents.data();
+    const char *end = cur + contents.size();
+    while (cur < end)
+    {
+        // Each step reads one field and leaves |cur| just past it. On anything unexpected, give up on the line and
+        // resume after its newline.
+        int first;
+        int second;
+        auto [dash, first_ec] = std::from_chars(cur, end, first);
+        auto [space, second_ec] = first_ec == std::errc() && dash < end && *dash == '-'
+                                      ? std::from_chars(dash + 1, end, second)
+                                      : std::from_chars_result{dash, std::errc::invalid_argument};
+        // " l:" after the second number
+        if (second_ec != std::errc() || end - space < 3 || space[0] != ' ' || space[2] != ':')
+        {
+            const char *newline = static_cast<const char *>(std::memchr(cur, '\n', end - cur));
+            cur = newline == nullptr ? end : newline + 1;
+            continue;
+        }
+        char letter = space[1];
+        cur = space + 3;
+        while (cur < end && *cur == ' ')
+        {
+            cur++;
+        }
+        // The password runs to the end of the line. Count the letter and note the two positions on the way there,
+        // so the bytes are only read once.
+        int letter_count = 0;
+        bool first_matches = false;
+        bool second_matches = false;
+        // 1-based in the policy, a position of 0 wraps around and never matches
+        std::size_t first_index = static_cast<std::size_t>(first) - 1;
+        std::size_t second_index = static_cast<std::size_t>(second) - 1;
+        for (std::size_t index = 0; cur < end && *cur != '\n'; cur++, index++)
+        {
+            bool is_letter = *cur == letter;
+            letter_count += is_letter;
+            first_matches |= is_letter && index == first_index;
+            second_matches |= is_letter && index == second_index;
+        }
+        counts.num_entries++;
+        counts.old_policy += letter_count >= first && letter_count <= second;
+        counts.new_policy += first_matches ^ second_matches;
+        // Skip the newline
+        cur++;
+    }
+    return counts;
 }
 
-int main(int argc, char const *argv[])
+ValidPasswordCounts count_valid_passwords_parallel(std::string_view contents, ThreadPool &pool,
+                                                   std::pmr::memory_resource *resource)
 {
-    std::string filepath("/home/drew/workspace/advent-of-code/day_2_input.txt");
-    { // PART ONE
-        std::vector<std::tuple<PasswordChecker, std::string>> file_entries = read_file(filepath, &OldPasswordPolicy::create_policy);
-        int valid_passwords = count_valid_passwords(file_entries);
-        std::cout << "Valid passwords (old): " << valid_passwords << std::endl;
+    std::pmr::vector<std::string_view> chunks =
+        split_into_chunks(contents, pool.num_threads() * 4, RecordBoundary::kNewline, resource);
+    // Allocated here rather than by the tasks, since |resource| may only be used by this thread
+    std::pmr::vector<ValidPasswordCounts> chunk_counts(chunks.size(), resource);
+    pool.parallel_for(chunks.size(), [&](std::size_t i) { chunk_counts[i] = scan_valid_passwords(chunks[i]); });
+    ValidPasswordCounts counts;
+    for (const ValidPasswordCounts &chunk : chunk_counts)
+    {
+        counts.num_entries += chunk.num_entries;
+        counts.old_policy += chunk.old_policy;
+        counts.new_policy += chunk.new_policy;
     }
-    { // PART TWO
-        std::vector<std::tuple<PasswordChecker, std::string>> file_entries = read_file(filepath, &NewPasswordPolicy::create_policy);
-        int valid_passwords = count_valid_passwords(file_entries);
-        std::cout << "Valid passwords (old): " << valid_passwords << std::endl;
+    return counts;
+}
+
+absl::StatusOr<ValidPasswordCounts> count_valid_passwords_streaming(int fd)
+{
+    ValidPasswordCounts counts;
+    absl::Status status = for_each_streamed_block(fd, [&counts](std::string_view block)
+    {
+        ValidPasswordCounts block_counts = scan_valid_passwords(block);
+        counts.num_entries += block_counts.num_entries;
+        counts.old_policy += block_counts.old_policy;
+        counts.new_policy += block_counts.new_policy;
+    });
+    if (!status.ok())
+    {
+        return status;
     }
-    return 0;
+    return counts;
 }
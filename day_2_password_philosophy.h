@@ -0,0 +1,184 @@
+#ifndef DAY_2_PASSWORD_PHILOSOPHY_H_
+#define DAY_2_PASSWORD_PHILOSOPHY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+class PasswordPolicy
+{
+public:
+    virtual bool check_password(std::string_view pw) const = 0;
+    virtual ~PasswordPolicy(){};
+};
+
+class PasswordChecker
+{
+public:
+    explicit PasswordChecker(std::unique_ptr<PasswordPolicy> policy) : policy_(std::move(policy)){};
+    bool check_password(std::string_view pw) const
+    {
+        return policy_->check_password(pw);
+    }
+
+private:
+    std::unique_ptr<PasswordPolicy> policy_;
+};
+
+// The fields of a policy string, as written. Each policy decides what the two numbers mean.
+struct PolicyFields
+{
+    int first;
+    int second;
+    char letter;
+};
+
+PolicyFields parse_policy_fields(std::string_view pw_policy_string);
+
+// OldPasswordPolicy encapsulates the corporate password policy which specifies
+// the min and max amount of a given letter.
+class OldPasswordPolicy : public PasswordPolicy
+{
+public:
+    bool check_password(std::string_view pw) const override { return check(min_, max_, letter_, pw); }
+    static std::unique_ptr<OldPasswordPolicy> create_policy(std::string_view pw_policy_string);
+    // Non-virtual version of the check for the batch path which doesn't create a policy object per line
+    static bool check(int min, int max, char letter, std::string_view pw);
+
+private:
+    OldPasswordPolicy(int min, int max, char letter) : min_(min), max_(max), letter_(letter){};
+    int min_;
+    int max_;
+    char letter_;
+};
+
+// NewPasswordPolicy encapsulates the corporate password policy which specifies
+// the first and second position where a given letter must be in ONLY one of those positions.
+class NewPasswordPolicy : public PasswordPolicy
+{
+public:
+    bool check_password(std::string_view pw) const override;
+    static std::unique_ptr<NewPasswordPolicy> create_policy(std::string_view pw_policy_string);
+    // Non-virtual version of the check for the batch path. |first| and |second| are 1-based as written in
+    // the policy string.
+    static bool check(int first, int second, char letter, std::string_view pw);
+
+private:
+    NewPasswordPolicy(int first_pos, int second_pos, char letter) : first_pos_(first_pos), second_pos_(second_pos), letter_(letter){};
+    int first_pos_;
+    int second_pos_;
+    char letter_;
+};
+
+void remove_trailing_whitespace(std::string_view &s);
+void remove_leading_whitespace(std::string_view &s);
+
+// Splits a "N-M l: pw" line into the policy string and the password (with the surrounding spaces removed).
+void split_policy_and_password(std::string_view line, std::string_view &policy, std::string_view &pw);
+
+template <typename PasswordPolicyFactoryFunction>
+std::vector<std::tuple<PasswordChecker, std::string_view>> parse_password_checkers(std::string_view contents, PasswordPolicyFactoryFunction create_policy_fn)
+{
+    // The passwords are views into |contents| so it must outlive the returned entries.
+    std::vector<std::tuple<PasswordChecker, std::string_view>> entries;
+    for_each_line(contents, [&](std::string_view current_line)
+    {
+        std::string_view policy;
+        std::string_view pw;
+        split_policy_and_password(current_line, policy, pw);
+        PasswordChecker checker(std::unique_ptr<PasswordPolicy>(create_policy_fn(policy).release()));
+        entries.push_back(std::make_tuple(std::move(checker), pw));
+    });
+    return entries;
+}
+
+int count_valid_passwords(std::span<std::tuple<PasswordChecker, std::string_view>> pw_and_policies);
+
+// PasswordBatch holds every parsed line as a structure of arrays. Unlike the PasswordChecker path there is no
+// heap allocated policy per line and no virtual call per check, the policy is picked at compile time by
+// count_valid_passwords<Policy> and the columns are walked sequentially. Since the fields are stored as written,
+// the same batch can be checked against either policy.
+struct PasswordBatch
+{
+    // The columns are allocated from |resource|, e.g. a per-run arena. It must outlive the batch.
+    explicit PasswordBatch(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : first(resource), second(resource), letter(resource), password(resource)
+    {
+    }
+
+    std::pmr::vector<int> first;
+    std::pmr::vector<int> second;
+    std::pmr::vector<char> letter;
+    // Views into the input file, which must outlive the batch
+    std::pmr::vector<std::string_view> password;
+
+    std::size_t size() const { return password.size(); }
+
+    void reserve(std::size_t num_entries)
+    {
+        first.reserve(num_entries);
+        second.reserve(num_entries);
+        letter.reserve(num_entries);
+        password.reserve(num_entries);
+    }
+
+    void add(const PolicyFields &fields, std::string_view pw)
+    {
+        first.push_back(fields.first);
+        second.push_back(fields.second);
+        letter.push_back(fields.letter);
+        password.push_back(pw);
+    }
+};
+
+// Parsing never allocates per line, the only allocations are the batch's columns, once each.
+PasswordBatch parse_password_batch(std::string_view contents,
+                                   std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+template <typename Policy>
+int count_valid_passwords(const PasswordBatch &batch)
+{
+    int valid_passwords = 0;
+    for (std::size_t i = 0; i < batch.size(); i++)
+    {
+        valid_passwords += Policy::check(batch.first[i], batch.second[i], batch.letter[i], batch.password[i]);
+    }
+    return valid_passwords;
+}
+
+// Specialized to count letters for a block of passwords at a time, see the definition.
+template <>
+int count_valid_passwords<OldPasswordPolicy>(const PasswordBatch &batch);
+
+// Both parts' answers for a whole input
+struct ValidPasswordCounts
+{
+    int64_t num_entries = 0;
+    int64_t old_policy = 0;
+    int64_t new_policy = 0;
+};
+
+// Walks the raw bytes of |contents| once, parsing each "N-M l: pw" line in place and checking the password against
+// both policies while it looks for the end of the line. Nothing is stored per line, unlike the PasswordBatch path
+// which writes every field out and reads them back for each policy. Lines that don't match the format are skipped.
+ValidPasswordCounts scan_valid_passwords(std::string_view contents);
+
+// Splits |contents| into chunks of lines, then scans each chunk on |pool| and adds up the counts. The scan itself
+// allocates nothing, the chunk list and per-chunk counts come from |resource|.
+ValidPasswordCounts count_valid_passwords_parallel(std::string_view contents, ThreadPool &pool,
+                                                   std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+// Reads lines from |fd| (e.g. stdin or a pipe) until the end of the stream and checks each one against both
+// policies as it arrives, so nothing is kept per line and memory use doesn't grow with the input.
+absl::StatusOr<ValidPasswordCounts> count_valid_passwords_streaming(int fd);
+
+#endif // DAY_2_PASSWORD_PHILOSOPHY_H_
@@ -0,0 +1,58 @@
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "day_2_password_philosophy.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+ABSL_FLAG(int, threads, 1, "Threads to parse and check with, 0 for one per core");
+ABSL_FLAG(std::string, input, "/home/drew/workspace/advent-of-code/day_2_input.txt", "Input file to solve, - to stream it from stdin");
+
+int main(int argc, char *argv[])
+{
+    absl::ParseCommandLine(argc, argv);
+    std::string filepath = absl::GetFlag(FLAGS_input);
+    ValidPasswordCounts counts;
+    if (filepath == "-")
+    {
+        // A pipe may never fit in memory, so check the lines as they arrive instead of reading it all first.
+        std::cout << "Streaming stdin" << std::endl;
+        auto streamed_counts = count_valid_passwords_streaming(STDIN_FILENO);
+        if (!streamed_counts.ok())
+        {
+            std::cerr << streamed_counts.status() << std::endl;
+            return -1;
+        }
+        counts = *streamed_counts;
+    }
+    else
+    {
+        std::cout << "Opening " << filepath << std::endl;
+        auto input_file = MappedFile::open(filepath);
+        if (!input_file.ok())
+        {
+            std::cerr << input_file.status() << std::endl;
+            return -1;
+        }
+        if (absl::GetFlag(FLAGS_threads) == 1)
+        {
+            // Both parts use the same lines so check each one against both policies while parsing it.
+            counts = scan_valid_passwords(input_file->contents());
+        }
+        else
+        {
+            ThreadPool pool(absl::GetFlag(FLAGS_threads));
+            counts = count_valid_passwords_parallel(input_file->contents(), pool);
+        }
+    }
+    std::cout << "Read " << counts.num_entries << " entries" << std::endl;
+    // PART ONE
+    std::cout << "Valid passwords (old): " << counts.old_policy << std::endl;
+    // PART TWO
+    std::cout << "Valid passwords (new): " << counts.new_policy << std::endl;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include <memory_resource>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "benchmark_util.h"
+#include "day_5_binary_boarding.h"
+
+static void BM_Parse(benchmark::State &state)
+{
+    const std::string &contents = cached_input(5, state.range(0));
+    std::pmr::vector<int> seat_ids;
+    for (auto _ : state)
+    {
+        seat_ids.clear();
+        decode_seat_ids(contents, seat_ids);
+        benchmark::DoNotOptimize(seat_ids.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Solve(benchmark::State &state)
+{
+    std::pmr::vector<int> seat_ids;
+    decode_seat_ids(cached_input(5, state.range(0)), seat_ids);
+    for (auto _ : state)
+    {
+        SeatMap seat_map;
+        for (int seat_id : seat_ids)
+        {
+            seat_map.mark_occupied(seat_id);
+        }
+        int free_seats = 0;
+        seat_map.for_each_free_seat([&free_seats](int) { free_seats++; });
+        benchmark::DoNotOptimize(seat_map.max_occupied_seat());
+        benchmark::DoNotOptimize(free_seats);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_CAPTURE(BM_Read, day_5, 5)->Apply(apply_record_counts);
+BENCHMARK(BM_Parse)->Apply(apply_record_counts);
+BENCHMARK(BM_Solve)->Apply(apply_record_counts);
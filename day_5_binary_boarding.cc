@@ -1,103 +1,297 @@
-// binary space partitioning to seat people.
-//  A seat might be specified like FBFBBFFRLR, where F means "front", B means "back",
-//  L means "left", and R means "right".
-
-// The first 7 characters will either be F or B; these specify exactly one of the 128
-// rows on the plane (numbered 0 through 127). Each letter tells you which half of a
-// region the given seat is in. Start with the whole list of rows; the first letter
-// indicates whether the seat is in the front (0 through 63) or the back (64 through 127).
-// The next letter indicates which half of that region the seat is in, and so on until
-//  you're left with exactly one row.
-
-#include <fstream>
-#include <iostream>
-#include <math.h>
-#include <string_view>
-#include <unordered_set>
-#include <vector>
-
-constexpr int calc_seat_id(int row, int col) { return (row * 8) + col; }
-
-const int kNumRows = 128;
-const int kRowPosChars = (int)log2(kNumRows);
-const int kNumCols = 8;
-const int kColPosChars = (int)log2(kNumCols);
-const int kMaxSeatId = calc_seat_id((kNumRows - 1), (kNumCols - 1));
-
-class SeatPosition
+#include "day_5_binary_boarding.h"
+
+#include <algorithm>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "cpu_dispatch.h"
+#include "debug_log.h"
+#include "input_reader.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define BOARDING_X86 1
+#endif
+
+namespace
 {
-public:
-    SeatPosition(int row, int col) : row_(row), col_(col), seat_id_(calc_seat_id(row, col)) {}
-    int seat_id() const { return seat_id_; }
 
-private:
-    const int row_;
-    const int col_;
-    const int seat_id_;
-};
+constexpr std::size_t kPassStride = kPassChars + 1;
+
+// Each kernel decodes the regular passes (exactly kPassChars then '\n') from |pos| onwards into |out| and returns the
+// position of the first pass it couldn't decode, either because the line is irregular or because a load from there
+// would run past the end of |contents|. |out| must have room for every pass left in |contents|.
+using DecodeFn = std::size_t (*)(std::string_view contents, std::size_t pos, int *&out);
 
-int calc_pos(std::string_view pos_string, int num_pos)
+std::size_t decode_regular_passes_scalar(std::string_view contents, std::size_t pos, int *&out)
 {
-    std::cout << pos_string << " ^ " << num_pos << std::endl;
-    int min_pos = 0;
-    int max_pos = max_pos - 1;
-    int partition_size = num_pos;
+    while (pos + kPassStride <= contents.size() && contents[pos + kPassChars] == '\n')
+    {
+        std::string_view pass = contents.substr(pos, kPassChars);
+        if (pass.find('\n') != std::string_view::npos)
+        {
+            break;
+        }
+        *out++ = decode_seat_id(pass);
+        pos += kPassStride;
+    }
+    return pos;
+}
+
+#if defined(BOARDING_X86)
 
-    for (char pos_char : pos_string)
+// movemask gives the first character in the lowest bit, but it's the most significant bit of the seat ID
+constexpr int reverse_pass_bits(int bits)
+{
+    bits = ((bits & 0x5555) << 1) | ((bits >> 1) & 0x5555);
+    bits = ((bits & 0x3333) << 2) | ((bits >> 2) & 0x3333);
+    bits = ((bits & 0x0f0f) << 4) | ((bits >> 4) & 0x0f0f);
+    bits = ((bits & 0x00ff) << 8) | ((bits >> 8) & 0x00ff);
+    return bits >> (16 - kPassChars);
+}
+
+static_assert(reverse_pass_bits(0b0000000001) == 0b1000000000);
+static_assert(reverse_pass_bits(0b0101100110) == 0b0110011010);
+
+// One pass per 16 byte load
+std::size_t decode_regular_passes_sse2(std::string_view contents, std::size_t pos, int *&out)
+{
+    const __m128i backs = _mm_set1_epi8('B');
+    const __m128i rights = _mm_set1_epi8('R');
+    const __m128i newlines = _mm_set1_epi8('\n');
+    while (pos + sizeof(__m128i) <= contents.size())
     {
-        partition_size /= 2;
-        if (pos_char == 'F' || pos_char == 'L')
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(contents.data() + pos));
+        // The pass's own newline and no other before it, or the line is irregular
+        int newline_bits = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, newlines)) & ((1 << kPassStride) - 1);
+        if (newline_bits != 1 << kPassChars)
         {
-            // Lower half
-            max_pos -= partition_size;
+            break;
         }
-        else
-        { // pos_char == 'B' || pos_char == 'R'
-            // Upper half
-            min_pos += partition_size;
+        int one_bits = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, backs), _mm_cmpeq_epi8(chars, rights)));
+        *out++ = reverse_pass_bits(one_bits & kMaxSeatId);
+        pos += kPassStride;
+    }
+    return pos;
+}
+
+// Three passes (33 bytes with their newlines) per 32 byte load. The register is byte reversed before the movemask so
+// each pass's first character lands in its most significant bit, and each seat ID is then a shift and a mask.
+constexpr int kPassesPerAvx2Load = 3;
+constexpr std::size_t kAvx2BatchBytes = kPassesPerAvx2Load * kPassStride;
+static_assert(kAvx2BatchBytes == sizeof(__m256i) + 1, "the last pass's newline is checked outside the register");
+constexpr uint32_t kAvx2Newlines = (uint32_t{1} << kPassChars) | (uint32_t{1} << (kPassStride + kPassChars));
+
+__attribute__((target("avx2"))) std::size_t decode_regular_passes_avx2(std::string_view contents, std::size_t pos,
+                                                                       int *&out)
+{
+    const __m256i backs = _mm256_set1_epi8('B');
+    const __m256i rights = _mm256_set1_epi8('R');
+    const __m256i newlines = _mm256_set1_epi8('\n');
+    const __m256i reverse_lane = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                                  15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    while (pos + kAvx2BatchBytes <= contents.size() && contents[pos + kAvx2BatchBytes - 1] == '\n')
+    {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(contents.data() + pos));
+        uint32_t newline_bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newlines)));
+        if (newline_bits != kAvx2Newlines)
+        {
+            break;
         }
+        __m256i one_chars = _mm256_or_si256(_mm256_cmpeq_epi8(chars, backs), _mm256_cmpeq_epi8(chars, rights));
+        // Reverse the bytes within each lane, then swap the lanes
+        __m256i reversed = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(one_chars, reverse_lane), 0x4e);
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(reversed));
+        // Byte i of the load is now bit 31 - i, so pass k's last character is at bit 31 - (k * kPassStride + 9)
+        out[0] = (bits >> (sizeof(__m256i) - kPassChars)) & kMaxSeatId;
+        out[1] = (bits >> (sizeof(__m256i) - kPassStride - kPassChars)) & kMaxSeatId;
+        out[2] = bits & kMaxSeatId;
+        out += kPassesPerAvx2Load;
+        pos += kAvx2BatchBytes;
     }
-    // min_row and max_row should now be equal, can return either
-    return min_pos;
+    // Less than a whole batch left, or an irregular line somewhere in it
+    return decode_regular_passes_sse2(contents, pos, out);
 }
 
-std::vector<SeatPosition> read_file(std::string_view filename)
+#endif // BOARDING_X86
+
+DecodeFn kernel()
 {
-    std::vector<SeatPosition> file_entries;
-    std::ifstream input_file_stream;
-    std::cout << "Opening " << filename << std::endl;
-    input_file_stream.open(std::string(filename), std::ios_base::in);
-    std::string current_line;
-    while (getline(input_file_stream, current_line))
+#if defined(BOARDING_X86)
+    return pick_simd_kernel(decode_regular_passes_scalar, decode_regular_passes_sse2, decode_regular_passes_avx2);
+#else
+    return decode_regular_passes_scalar;
+#endif
+}
+
+// Only lines of at least kPassChars are decoded and all but the last end in a newline, which bounds how many
+// passes there can be
+std::size_t max_passes(std::string_view contents) { return contents.size() / kPassStride + 1; }
+
+// Decodes every pass in |contents| into |out|, which must have room for max_passes(contents) seat IDs. Returns the
+// end of the seat IDs written.
+int *decode_seat_ids_into(std::string_view contents, int *out)
+{
+    std::size_t pos = 0;
+    while (pos < contents.size())
     {
-        std::string_view current_line_view = std::string_view(current_line);
-        int row_pos = calc_pos(current_line_view.substr(0, kRowPosChars), kNumRows);
-        int col_pos = calc_pos(current_line_view.substr(kRowPosChars, kColPosChars), kNumCols);
-        std::cout << current_line_view << " => (" << row_pos << ", " << col_pos << ")" << std::endl;
-        file_entries.emplace_back(row_pos, col_pos);
+        pos = kernel()(contents, pos, out);
+        if (pos >= contents.size())
+        {
+            break;
+        }
+        // An irregular line (e.g. ending in "\r\n" or too short) or the last few passes, where a load could run off
+        // the end of the mapping. Decode just that line, then go back to the kernel from the next one.
+        std::size_t line_end = std::min(contents.find('\n', pos), contents.size());
+        std::string_view line = contents.substr(pos, line_end - pos);
+        if (line.size() >= kPassChars)
+        {
+            *out++ = decode_seat_id(line);
+            AOC_DEBUG_LOG("%s => seat %d", line, out[-1]);
+        }
+        else if (!line.empty())
+        {
+            AOC_DEBUG_LOG("skipping short pass \"%s\"", line);
+        }
+        pos = line_end + 1;
     }
-    std::cout << "Read " << file_entries.size() << " entries" << std::endl;
-    return file_entries;
+    return out;
+}
+
+} // namespace
+
+void decode_seat_ids(std::string_view contents, std::pmr::vector<int> &seat_ids)
+{
+    std::size_t old_size = seat_ids.size();
+    seat_ids.resize(old_size + max_passes(contents));
+    int *end = decode_seat_ids_into(contents, seat_ids.data() + old_size);
+    seat_ids.resize(end - seat_ids.data());
 }
 
-int main(int argc, char const *argv[])
+int64_t build_seat_map(std::string_view contents, ThreadPool &pool, SeatMap &seat_map,
+                       std::pmr::memory_resource *resource)
 {
-    std::vector<SeatPosition> pos_vec = read_file("/home/drew/workspace/advent-of-code/day_5_input.txt");
-    int max_seat_id = 0;
-    std::unordered_set<int> seats(kMaxSeatId + 1);
-    // Fill the set with all the seats (to be removed once we've determined all the filled seats)
-    for (int i = 0; i < kMaxSeatId + 1; i++) {
-        seats.insert(i);
+    std::pmr::vector<std::string_view> chunks =
+        split_into_chunks(contents, pool.num_threads() * 4, RecordBoundary::kNewline, resource);
+    std::pmr::vector<SeatMap> chunk_maps(chunks.size(), resource);
+    std::pmr::vector<int64_t> chunk_passes(chunks.size(), resource);
+    // Every chunk decodes into its own slice of one buffer, allocated here since the tasks can't use |resource|
+    std::pmr::vector<std::size_t> chunk_offsets(chunks.size() + 1, 0, resource);
+    for (std::size_t i = 0; i < chunks.size(); i++)
+    {
+        chunk_offsets[i + 1] = chunk_offsets[i] + max_passes(chunks[i]);
     }
-    for (const SeatPosition &seat_pos : pos_vec)
+    std::pmr::vector<int> seat_ids(chunk_offsets.back(), resource);
+    pool.parallel_for(chunks.size(), [&](std::size_t i)
+    {
+        int *begin = seat_ids.data() + chunk_offsets[i];
+        int *end = decode_seat_ids_into(chunks[i], begin);
+        for (const int *seat_id = begin; seat_id != end; seat_id++)
+        {
+            chunk_maps[i].mark_occupied(*seat_id);
+        }
+        chunk_passes[i] = end - begin;
+    });
+    int64_t num_passes = 0;
+    for (std::size_t i = 0; i < chunks.size(); i++)
     {
-        seats.erase(seat_pos.seat_id());
-        max_seat_id = std::max(max_seat_id, seat_pos.seat_id());
+        seat_map.merge(chunk_maps[i]);
+        num_passes += chunk_passes[i];
     }
-    std::cout << "Max seat ID: " << max_seat_id << std::endl;
-    std::cout << "Seats left: " << std::endl;
-    for (int seat : seats) {
-        std::cout << " " << seat << std::endl;
+    return num_passes;
+}
+
+absl::StatusOr<int64_t> build_seat_map_streaming(int fd, SeatMap &seat_map)
+{
+    // Reused for every block, so it only grows to the biggest one
+    std::pmr::vector<int> seat_ids;
+    int64_t num_passes = 0;
+    absl::Status status = for_each_streamed_block(fd, [&](std::string_view block)
+    {
+        seat_ids.clear();
+        decode_seat_ids(block, seat_ids);
+        for (int seat_id : seat_ids)
+        {
+            seat_map.mark_occupied(seat_id);
+        }
+        num_passes += seat_ids.size();
+    });
+    if (!status.ok())
+    {
+        return status;
+    }
+    return num_passes;
+}
+
+absl::StatusOr<RuntimeSeatMap> RuntimeSeatMap::create(int num_rows, int num_cols)
+{
+    if (num_rows <= 0 || num_cols <= 0 || !std::has_single_bit(unsigned(num_rows)) ||
+        !std::has_single_bit(unsigned(num_cols)) || int64_t{num_rows} * num_cols > (int64_t{1} << 30))
+    {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("a plane of %d rows by %d columns can't be addressed by a boarding pass", num_rows, num_cols));
+    }
+    int pass_chars = std::bit_width(unsigned(num_rows)) - 1 + std::bit_width(unsigned(num_cols)) - 1;
+    return RuntimeSeatMap(pass_chars, num_rows * num_cols);
+}
+
+int64_t RuntimeSeatMap::mark_seats(std::string_view contents)
+{
+    int64_t num_passes = 0;
+    for_each_line(contents, [&](std::string_view line)
+    {
+        if (line.size() >= static_cast<std::size_t>(pass_chars_))
+        {
+            mark_occupied(decode_seat_id(line, pass_chars_));
+            num_passes++;
+        }
+    });
+    return num_passes;
+}
+
+int RuntimeSeatMap::max_occupied_seat() const
+{
+    for (int seat = static_cast<int>(occupied_.size()) - 1; seat >= 0; seat--)
+    {
+        if (occupied_[seat])
+        {
+            return seat;
+        }
+    }
+    return -1;
+}
+
+int RuntimeSeatMap::find_my_seat() const
+{
+    for (int seat = static_cast<int>(occupied_.size()) - 2; seat >= 1; seat--)
+    {
+        if (!occupied_[seat] && occupied_[seat - 1] && occupied_[seat + 1])
+        {
+            return seat;
+        }
+    }
+    return -1;
+}
+
+absl::StatusOr<BoardingAnswers> solve_boarding(std::string_view contents, int num_rows, int num_cols)
+{
+    if (num_rows == kNumRows && num_cols == kNumCols)
+    {
+        std::pmr::vector<int> seat_ids;
+        decode_seat_ids(contents, seat_ids);
+        SeatMap seat_map;
+        for (int seat_id : seat_ids)
+        {
+            seat_map.mark_occupied(seat_id);
+        }
+        return BoardingAnswers{static_cast<int64_t>(seat_ids.size()), seat_map.max_occupied_seat(),
+                               seat_map.find_my_seat()};
+    }
+    auto seat_map = RuntimeSeatMap::create(num_rows, num_cols);
+    if (!seat_map.ok())
+    {
+        return seat_map.status();
     }
-    return 0;
+    int64_t num_passes = seat_map->mark_seats(contents);
+    return BoardingAnswers{num_passes, seat_map->max_occupied_seat(), seat_map->find_my_seat()};
 }
@@ -0,0 +1,417 @@
+// binary space partitioning to seat people.
+//  A seat might be specified like FBFBBFFRLR, where F means "front", B means "back",
+//  L means "left", and R means "right".
+
+// The first 7 characters will either be F or B; these specify exactly one of the 128
+// rows on the plane (numbered 0 through 127). Each letter tells you which half of a
+// region the given seat is in. Start with the whole list of rows; the first letter
+// indicates whether the seat is in the front (0 through 63) or the back (64 through 127).
+// The next letter indicates which half of that region the seat is in, and so on until
+//  you're left with exactly one row.
+
+#ifndef DAY_5_BINARY_BOARDING_H_
+#define DAY_5_BINARY_BOARDING_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+// PlaneGeometry fixes the plane's rows and columns at compile time, so the pass length, the shifts that decode it
+// and the size of the seat bitmap are all constants and loops over them can be fully unrolled. Both must be powers
+// of two for the F/B and L/R halving to land on a single seat.
+template <int NumRows, int NumCols>
+struct PlaneGeometry
+{
+    static_assert(std::has_single_bit(unsigned(NumRows)) && std::has_single_bit(unsigned(NumCols)),
+                  "rows and columns must be powers of two");
+
+    static constexpr int kNumRows = NumRows;
+    static constexpr int kRowPosChars = std::bit_width(unsigned(NumRows)) - 1;
+    static constexpr int kNumCols = NumCols;
+    static constexpr int kColPosChars = std::bit_width(unsigned(NumCols)) - 1;
+    static constexpr int kPassChars = kRowPosChars + kColPosChars;
+    static constexpr int kMaxSeatId = (NumRows * NumCols) - 1;
+};
+
+// The plane from the puzzle
+using DefaultPlane = PlaneGeometry<128, 8>;
+
+template <typename Plane = DefaultPlane>
+constexpr int calc_seat_id(int row, int col) { return (row * Plane::kNumCols) + col; }
+
+constexpr int kNumRows = DefaultPlane::kNumRows;
+constexpr int kRowPosChars = DefaultPlane::kRowPosChars;
+constexpr int kNumCols = DefaultPlane::kNumCols;
+constexpr int kColPosChars = DefaultPlane::kColPosChars;
+constexpr int kPassChars = DefaultPlane::kPassChars;
+constexpr int kMaxSeatId = DefaultPlane::kMaxSeatId;
+
+// The F/B and L/R halving is just binary: F and L are 0, B and R are 1, and the first character is the
+// most significant bit. Since the seat ID is row * kNumCols + col, the whole pass read as one binary
+// number IS the seat ID, no need to decode the row and column separately.
+// 'B' (0x42) and 'R' (0x52) have bit 2 clear while 'F' (0x46) and 'L' (0x4C) have it set, so each bit can be
+// pulled out of the character without a branch.
+constexpr int pass_char_bit(char pos_char) { return (~pos_char >> 2) & 1; }
+
+template <typename Plane = DefaultPlane>
+constexpr int decode_seat_id(std::string_view pass)
+{
+    int seat_id = 0;
+    for (int i = 0; i < Plane::kPassChars; i++)
+    {
+        seat_id = (seat_id << 1) | pass_char_bit(pass[i]);
+    }
+    return seat_id;
+}
+
+// Same for a plane whose geometry is only known at runtime, where a pass is |pass_chars| long.
+constexpr int decode_seat_id(std::string_view pass, int pass_chars)
+{
+    int seat_id = 0;
+    for (int i = 0; i < pass_chars; i++)
+    {
+        seat_id = (seat_id << 1) | pass_char_bit(pass[i]);
+    }
+    return seat_id;
+}
+
+static_assert(decode_seat_id("FBFBBFFRLR") == calc_seat_id(44, 5));
+static_assert(decode_seat_id<PlaneGeometry<4, 4>>("BFLR") == calc_seat_id<PlaneGeometry<4, 4>>(2, 1));
+
+// Decodes every boarding pass in |contents| and appends the seat IDs to |seat_ids|.
+// Passes are normally a fixed kPassChars + '\n' apart, which lets us walk the raw bytes directly: a compare against
+// 'B' and 'R' and a movemask turn a whole register of characters into seat ID bits, three passes per load with AVX2
+// (one with SSE2), picked at runtime. An irregular line (and the last few passes, where a load could run off the
+// end of the mapping) goes through the scalar decoder on its own, and the vector kernel picks up again on the
+// next line.
+// |seat_ids| is a pmr vector so the runner can keep it in its per-job arena.
+void decode_seat_ids(std::string_view contents, std::pmr::vector<int> &seat_ids);
+
+// BasicSeatMap tracks which seats of a |Plane| are occupied with one bit per seat ID, so the whole default plane is
+// 16 words and the max and free seat queries are word scans instead of hash set lookups. Everything is constexpr so
+// a map can be built from an input embedded at compile time.
+template <typename Plane>
+class BasicSeatMap
+{
+public:
+    static constexpr int kMaxSeatId = Plane::kMaxSeatId;
+    static constexpr int kNumWords = (kMaxSeatId + 1 + 63) / 64;
+    // One bit per seat ID, as used by the bulk queries below
+    using Bits = std::array<uint64_t, kNumWords>;
+
+    constexpr void mark_occupied(int seat_id) { words_[seat_id / 64] |= uint64_t{1} << (seat_id % 64); }
+
+    // Adds every seat occupied in |other|, e.g. to combine maps built from different chunks of the input
+    constexpr void merge(const BasicSeatMap &other)
+    {
+        for (int word = 0; word < kNumWords; word++)
+        {
+            words_[word] |= other.words_[word];
+        }
+    }
+
+    constexpr bool is_occupied(int seat_id) const { return (words_[seat_id / 64] >> (seat_id % 64)) & 1; }
+
+    constexpr int num_occupied() const
+    {
+        int num_occupied = 0;
+        for (uint64_t word : words_)
+        {
+            num_occupied += std::popcount(word);
+        }
+        return num_occupied;
+    }
+
+    // Returns -1 if no seat is occupied
+    constexpr int max_occupied_seat() const
+    {
+        for (int word = kNumWords - 1; word >= 0; word--)
+        {
+            if (words_[word] != 0)
+            {
+                return word * 64 + 63 - std::countl_zero(words_[word]);
+            }
+        }
+        return -1;
+    }
+
+    constexpr Bits free_bits() const
+    {
+        Bits free{};
+        for (int word = 0; word < kNumWords; word++)
+        {
+            free[word] = ~words_[word] & valid_bits(word);
+        }
+        return free;
+    }
+
+    // Calls |seat_fn| with every free seat ID in ascending order
+    template <typename SeatFn>
+    constexpr void for_each_free_seat(SeatFn seat_fn) const
+    {
+        for_each_seat(free_bits(), seat_fn);
+    }
+
+    // The free seats with both neighbours taken, which is the rule for your seat. The occupied bits are shifted one seat
+    // each way (carrying across words) and ANDed, so this is a few operations per word rather than per seat. The
+    // seats at the very front and back only have one neighbour and never count.
+    constexpr Bits isolated_free_bits() const
+    {
+        Bits isolated{};
+        for (int word = 0; word < kNumWords; word++)
+        {
+            uint64_t occupied = words_[word];
+            uint64_t before_occupied = (occupied << 1) | (word > 0 ? words_[word - 1] >> 63 : 0);
+            uint64_t after_occupied = (occupied >> 1) | (word + 1 < kNumWords ? words_[word + 1] << 63 : 0);
+            isolated[word] = ~occupied & before_occupied & after_occupied & valid_bits(word);
+        }
+        return isolated;
+    }
+
+    // Your seat is the free one with both neighbours taken. If there are several, the one furthest back.
+    // Returns -1 if there is no such seat.
+    constexpr int find_my_seat() const { return max_seat(isolated_free_bits()); }
+
+    // Bit s is set if the |run_length| seats from s onwards are all free and in the same row, e.g. for seating a
+    // group together. Runs are found by ANDing the free bits with themselves shifted, doubling the length each time.
+    // |run_length| must be between 1 and the number of columns.
+    constexpr Bits free_run_bits(int run_length) const
+    {
+        Bits runs = free_bits();
+        for (int length = 1; length < run_length;)
+        {
+            int shift = std::min(length, run_length - length);
+            Bits shifted = shift_down(runs, shift);
+            for (int word = 0; word < kNumWords; word++)
+            {
+                runs[word] &= shifted[word];
+            }
+            length += shift;
+        }
+        // A run can't start in the last |run_length| - 1 seats of a row, those would spill into the next row
+        if constexpr (Plane::kNumCols <= 64)
+        {
+            // Rows are a power of two wide so every word holds whole rows, and the same mask fits them all
+            uint64_t run_starts = 0;
+            for (int bit = 0; bit < 64; bit++)
+            {
+                run_starts |= uint64_t{bit % Plane::kNumCols <= Plane::kNumCols - run_length} << bit;
+            }
+            for (uint64_t &word : runs)
+            {
+                word &= run_starts;
+            }
+        }
+        else
+        {
+            // Rows are whole words, so the mask depends only on where the word is in its row
+            constexpr int kWordsPerRow = Plane::kNumCols / 64;
+            for (int word_in_row = 0; word_in_row < kWordsPerRow; word_in_row++)
+            {
+                // The last bit of this word a run can start at
+                int last_start = Plane::kNumCols - run_length - word_in_row * 64;
+                uint64_t run_starts = last_start >= 63 ? ~uint64_t{0}
+                                      : last_start < 0 ? 0
+                                                       : (uint64_t{1} << (last_start + 1)) - 1;
+                for (int row = 0; row < Plane::kNumRows; row++)
+                {
+                    runs[row * kWordsPerRow + word_in_row] &= run_starts;
+                }
+            }
+        }
+        return runs;
+    }
+
+    // The number of occupied seats in every row
+    constexpr std::array<int, Plane::kNumRows> row_occupancy() const
+    {
+        std::array<int, Plane::kNumRows> occupancy{};
+        if constexpr (Plane::kNumCols <= 64)
+        {
+            // Rows are a power of two wide so they never straddle words, each is one masked popcount
+            constexpr uint64_t kRowMask = Plane::kNumCols == 64 ? ~uint64_t{0} : (uint64_t{1} << Plane::kNumCols) - 1;
+            for (int row = 0; row < Plane::kNumRows; row++)
+            {
+                int first_seat = row * Plane::kNumCols;
+                occupancy[row] = std::popcount((words_[first_seat / 64] >> (first_seat % 64)) & kRowMask);
+            }
+        }
+        else
+        {
+            // Rows are whole words
+            constexpr int kWordsPerRow = Plane::kNumCols / 64;
+            for (int row = 0; row < Plane::kNumRows; row++)
+            {
+                for (int word = row * kWordsPerRow; word < (row + 1) * kWordsPerRow; word++)
+                {
+                    occupancy[row] += std::popcount(words_[word]);
+                }
+            }
+        }
+        return occupancy;
+    }
+
+    // Calls |seat_fn| with every seat set in |bits| in ascending order
+    template <typename SeatFn>
+    static constexpr void for_each_seat(const Bits &bits, SeatFn seat_fn)
+    {
+        for (int word = 0; word < kNumWords; word++)
+        {
+            uint64_t remaining = bits[word];
+            while (remaining != 0)
+            {
+                seat_fn(word * 64 + std::countr_zero(remaining));
+                // Clear the lowest set bit
+                remaining &= remaining - 1;
+            }
+        }
+    }
+
+    static constexpr int count_seats(const Bits &bits)
+    {
+        int num_seats = 0;
+        for (uint64_t word : bits)
+        {
+            num_seats += std::popcount(word);
+        }
+        return num_seats;
+    }
+
+    // The highest seat set in |bits|, or -1 if there is none
+    static constexpr int max_seat(const Bits &bits)
+    {
+        for (int word = kNumWords - 1; word >= 0; word--)
+        {
+            if (bits[word] != 0)
+            {
+                return word * 64 + 63 - std::countl_zero(bits[word]);
+            }
+        }
+        return -1;
+    }
+
+private:
+    // Seat IDs past kMaxSeatId don't exist, which only matters when the plane isn't a multiple of 64 seats
+    static constexpr uint64_t valid_bits(int word)
+    {
+        int seats_in_word = std::min(64, kMaxSeatId + 1 - word * 64);
+        return seats_in_word == 64 ? ~uint64_t{0} : (uint64_t{1} << seats_in_word) - 1;
+    }
+
+    // Bit s of the result is bit s + |shift| of |bits|
+    static constexpr Bits shift_down(const Bits &bits, int shift)
+    {
+        int word_shift = shift / 64;
+        int bit_shift = shift % 64;
+        Bits shifted{};
+        for (int word = 0; word + word_shift < kNumWords; word++)
+        {
+            uint64_t low = bits[word + word_shift];
+            uint64_t high = word + word_shift + 1 < kNumWords ? bits[word + word_shift + 1] : 0;
+            shifted[word] = bit_shift == 0 ? low : (low >> bit_shift) | (high << (64 - bit_shift));
+        }
+        return shifted;
+    }
+
+    Bits words_{};
+};
+
+using SeatMap = BasicSeatMap<DefaultPlane>;
+
+// Marks every pass in |contents| in |seat_map| with the plain scalar decoder and returns the number of passes.
+// Unlike decode_seat_ids this can run at compile time, e.g. on an input embedded with embedded_input().
+template <typename Plane>
+constexpr int64_t mark_seats(std::string_view contents, BasicSeatMap<Plane> &seat_map)
+{
+    int64_t num_passes = 0;
+    for_each_line(contents, [&](std::string_view line)
+    {
+        if (line.size() >= Plane::kPassChars)
+        {
+            seat_map.mark_occupied(decode_seat_id<Plane>(line));
+            num_passes++;
+        }
+    });
+    return num_passes;
+}
+
+struct BoardingAnswers
+{
+    int64_t num_passes = 0;
+    int max_seat = -1;
+    int my_seat = -1;
+};
+
+template <typename Plane>
+constexpr BoardingAnswers solve_boarding(std::string_view contents)
+{
+    BasicSeatMap<Plane> seat_map;
+    int64_t num_passes = mark_seats(contents, seat_map);
+    return BoardingAnswers{num_passes, seat_map.max_occupied_seat(), seat_map.find_my_seat()};
+}
+
+// The seat queries of BasicSeatMap for a plane whose geometry is only known at runtime. The bitmap is sized by
+// create() instead of the template, so nothing here is constexpr and the queries are plain loops over the seats.
+class RuntimeSeatMap
+{
+public:
+    // Returns InvalidArgument if either dimension isn't a power of two
+    static absl::StatusOr<RuntimeSeatMap> create(int num_rows, int num_cols);
+
+    // Marks every pass in |contents| and returns the number of passes
+    int64_t mark_seats(std::string_view contents);
+
+    void mark_occupied(int seat_id) { occupied_[seat_id] = true; }
+
+    // Returns -1 if no seat is occupied
+    int max_occupied_seat() const;
+
+    // Same rule as BasicSeatMap::find_my_seat
+    int find_my_seat() const;
+
+    // Calls |seat_fn| with every free seat ID in ascending order
+    template <typename SeatFn>
+    void for_each_free_seat(SeatFn seat_fn) const
+    {
+        for (std::size_t seat = 0; seat < occupied_.size(); seat++)
+        {
+            if (!occupied_[seat])
+            {
+                seat_fn(static_cast<int>(seat));
+            }
+        }
+    }
+
+private:
+    RuntimeSeatMap(int pass_chars, int num_seats) : pass_chars_(pass_chars), occupied_(num_seats) {}
+
+    int pass_chars_;
+    std::vector<bool> occupied_;
+};
+
+// Solves a plane of |num_rows| by |num_cols| seats, for geometries that aren't known when building. The default
+// plane still goes through the vectorized decoder, anything else uses a RuntimeSeatMap.
+// Returns InvalidArgument if either dimension isn't a power of two.
+absl::StatusOr<BoardingAnswers> solve_boarding(std::string_view contents, int num_rows, int num_cols);
+
+// Decodes every pass in |contents| on |pool| and marks them in |seat_map|. Each chunk of the input gets its own
+// SeatMap which are merged at the end, so the workers never write to a shared bitmap. Returns the number of passes.
+// The chunk list, the chunks' maps and the buffer they decode into are allocated from |resource|.
+int64_t build_seat_map(std::string_view contents, ThreadPool &pool, SeatMap &seat_map,
+                       std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+// Reads passes from |fd| (e.g. stdin or a pipe) until the end of the stream and marks them in |seat_map| as they
+// arrive. Only one buffer's worth of seat IDs is decoded at a time, so memory use doesn't grow with the input.
+// Returns the number of passes.
+absl::StatusOr<int64_t> build_seat_map_streaming(int fd, SeatMap &seat_map);
+
+#endif // DAY_5_BINARY_BOARDING_H_
@@ -0,0 +1,109 @@
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "day_5_binary_boarding.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+ABSL_FLAG(int, threads, 1, "Threads to decode passes with, 0 for one per core");
+ABSL_FLAG(int, rows, kNumRows, "Rows on the plane, must be a power of two");
+ABSL_FLAG(int, cols, kNumCols, "Seats per row, must be a power of two");
+ABSL_FLAG(std::string, input, "/home/drew/workspace/advent-of-code/day_5_input.txt", "Input file to solve, - to stream it from stdin");
+
+int main(int argc, char *argv[])
+{
+    absl::ParseCommandLine(argc, argv);
+    std::string filename = absl::GetFlag(FLAGS_input);
+    // Both seat maps have the same queries, so either plane prints the same way
+    auto print_seats = [](const auto &seat_map)
+    {
+        std::cout << "Max seat ID: " << seat_map.max_occupied_seat() << std::endl;
+        std::cout << "Seats left: " << std::endl;
+        seat_map.for_each_free_seat([](int seat) { std::cout << " " << seat << std::endl; });
+    };
+    if (absl::GetFlag(FLAGS_rows) != kNumRows || absl::GetFlag(FLAGS_cols) != kNumCols)
+    {
+        // Some other plane, which can only be sized at runtime
+        auto seat_map = RuntimeSeatMap::create(absl::GetFlag(FLAGS_rows), absl::GetFlag(FLAGS_cols));
+        if (!seat_map.ok())
+        {
+            std::cerr << seat_map.status() << std::endl;
+            return -1;
+        }
+        int64_t num_passes = 0;
+        if (filename == "-")
+        {
+            std::cout << "Streaming stdin" << std::endl;
+            absl::Status status = for_each_streamed_block(
+                STDIN_FILENO, [&](std::string_view block) { num_passes += seat_map->mark_seats(block); });
+            if (!status.ok())
+            {
+                std::cerr << status << std::endl;
+                return -1;
+            }
+        }
+        else
+        {
+            std::cout << "Opening " << filename << std::endl;
+            auto input_file = MappedFile::open(filename);
+            if (!input_file.ok())
+            {
+                std::cerr << input_file.status() << std::endl;
+                return -1;
+            }
+            num_passes = seat_map->mark_seats(input_file->contents());
+        }
+        std::cout << "Read " << num_passes << " entries" << std::endl;
+        print_seats(*seat_map);
+        return 0;
+    }
+    SeatMap seat_map;
+    if (filename == "-")
+    {
+        // A pipe may never fit in memory, so mark the passes as they arrive instead of reading it all first.
+        std::cout << "Streaming stdin" << std::endl;
+        auto num_passes = build_seat_map_streaming(STDIN_FILENO, seat_map);
+        if (!num_passes.ok())
+        {
+            std::cerr << num_passes.status() << std::endl;
+            return -1;
+        }
+        std::cout << "Read " << *num_passes << " entries" << std::endl;
+    }
+    else
+    {
+        std::cout << "Opening " << filename << std::endl;
+        auto input_file = MappedFile::open(filename);
+        if (!input_file.ok())
+        {
+            std::cerr << input_file.status() << std::endl;
+            return -1;
+        }
+        if (absl::GetFlag(FLAGS_threads) == 1)
+        {
+            std::pmr::vector<int> seat_ids;
+            decode_seat_ids(input_file->contents(), seat_ids);
+            std::cout << "Read " << seat_ids.size() << " entries" << std::endl;
+            for (int seat_id : seat_ids)
+            {
+                seat_map.mark_occupied(seat_id);
+            }
+        }
+        else
+        {
+            ThreadPool pool(absl::GetFlag(FLAGS_threads));
+            int64_t num_passes = build_seat_map(input_file->contents(), pool, seat_map);
+            std::cout << "Read " << num_passes << " entries" << std::endl;
+        }
+    }
+    print_seats(seat_map);
+    return 0;
+}
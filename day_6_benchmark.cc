@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "benchmark_util.h"
+#include "day_6_custom_customs.h"
+#include "input_reader.h"
+#include "wide_answer_matrix.h"
+
+// The real solver fuses parsing and solving into one pass (BM_ParseAndSolve). To still see the two phases
+// separately, parsing here means turning every line into an answer mask, with 0 marking the blank lines
+// (every generated person answers at least one question so 0 is never a real mask).
+static std::vector<uint32_t> parse_masks(std::string_view contents)
+{
+    std::vector<uint32_t> masks;
+    for_each_line(contents, [&masks](std::string_view line) { masks.push_back(answer_mask(line)); });
+    return masks;
+}
+
+static void BM_Parse(benchmark::State &state)
+{
+    const std::string &contents = cached_input(6, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(parse_masks(contents));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Solve(benchmark::State &state)
+{
+    const std::vector<uint32_t> masks = parse_masks(cached_input(6, state.range(0)));
+    for (auto _ : state)
+    {
+        GroupAnswerAggregator aggregator;
+        for (uint32_t mask : masks)
+        {
+            if (mask == 0)
+            {
+                aggregator.end_group();
+            }
+            else
+            {
+                aggregator.add_person(mask);
+            }
+        }
+        benchmark::DoNotOptimize(aggregator.finish());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_ParseAndSolve(benchmark::State &state)
+{
+    const std::string &contents = cached_input(6, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sum_group_answers(contents));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The generated inputs only use a-z, which the wide matrix parses as 26 of its 256 codes, so these solve the same
+// groups as above and show what the wider rows cost.
+static void BM_WideParse(benchmark::State &state)
+{
+    const std::string &contents = cached_input(6, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(WideAnswerMatrix::parse(contents));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_WideSolve(benchmark::State &state)
+{
+    const WideAnswerMatrix matrix = WideAnswerMatrix::parse(cached_input(6, state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(matrix.sum_group_answers());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_CAPTURE(BM_Read, day_6, 6)->Apply(apply_record_counts);
+BENCHMARK(BM_Parse)->Apply(apply_record_counts);
+BENCHMARK(BM_Solve)->Apply(apply_record_counts);
+BENCHMARK(BM_ParseAndSolve)->Apply(apply_record_counts);
+BENCHMARK(BM_WideParse)->Apply(apply_record_counts);
+BENCHMARK(BM_WideSolve)->Apply(apply_record_counts);
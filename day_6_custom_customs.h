@@ -0,0 +1,127 @@
+#ifndef DAY_6_CUSTOM_CUSTOMS_H_
+#define DAY_6_CUSTOM_CUSTOMS_H_
+
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+// The form asks a series of 26 yes-or-no questions marked a through z.
+// All you need to do is identify the questions for which anyone in your group answers "yes".
+
+// Each group's answers are separated by a blank line, and within each group,
+// each person's answers are on a single line.
+
+// Part 1
+// For each group, count the number of questions to which anyone answered "yes".
+// What is the sum of those counts?
+
+// Part 2
+// For each group, count the number of questions to which everyone answered "yes".
+// What is the sum of those counts?
+
+// Since there are only 26 questions, a person's answers fit in the low bits of a 32-bit mask (bit 0 is 'a').
+// The "anyone" answers of a group are then the OR of its members' masks and the "everyone" answers are the AND,
+// and the count for either is just a popcount. This avoids building a hash set per group and per passenger.
+constexpr uint32_t answer_mask(std::string_view line)
+{
+    uint32_t mask = 0;
+    for (char answer : line)
+    {
+        uint32_t question = static_cast<unsigned char>(answer) - 'a';
+        // Anything that isn't a-z (e.g. a stray '\r') is ignored rather than shifting garbage into the mask.
+        mask |= question < 26 ? (1u << question) : 0;
+    }
+    return mask;
+}
+
+struct GroupAnswerCounts
+{
+    int64_t num_groups = 0;
+    int64_t anyone = 0;
+    int64_t everyone = 0;
+
+    constexpr GroupAnswerCounts &operator+=(const GroupAnswerCounts &other)
+    {
+        num_groups += other.num_groups;
+        anyone += other.anyone;
+        everyone += other.everyone;
+        return *this;
+    }
+};
+
+// GroupAnswerAggregator consumes the input one line at a time and keeps a running total for both parts,
+// so nothing has to be stored per group. An empty line ends the current group.
+class GroupAnswerAggregator
+{
+public:
+    constexpr void add_line(std::string_view line)
+    {
+        if (line.empty())
+        {
+            end_group();
+            return;
+        }
+        add_person(answer_mask(line));
+    }
+
+    // Same as add_line for callers that already have the person's answer_mask
+    constexpr void add_person(uint32_t mask)
+    {
+        anyone_mask_ |= mask;
+        everyone_mask_ &= mask;
+        in_group_ = true;
+    }
+
+    constexpr void end_group()
+    {
+        // Consecutive blank lines shouldn't count as empty groups
+        if (!in_group_)
+        {
+            return;
+        }
+        counts_.num_groups++;
+        counts_.anyone += std::popcount(anyone_mask_);
+        counts_.everyone += std::popcount(everyone_mask_);
+        anyone_mask_ = 0;
+        everyone_mask_ = ~uint32_t{0};
+        in_group_ = false;
+    }
+
+    // Closes the last group (the input doesn't have to end with a blank line) and returns the totals.
+    constexpr GroupAnswerCounts finish()
+    {
+        end_group();
+        return counts_;
+    }
+
+private:
+    uint32_t anyone_mask_ = 0;
+    uint32_t everyone_mask_ = ~uint32_t{0};
+    bool in_group_ = false;
+    GroupAnswerCounts counts_;
+};
+
+// Computes both parts in a single pass over the raw input. This can also run at compile time, e.g. on an input
+// embedded with embedded_input().
+constexpr GroupAnswerCounts sum_group_answers(std::string_view contents)
+{
+    GroupAnswerAggregator aggregator;
+    for_each_line(contents, [&aggregator](std::string_view line) { aggregator.add_line(line); });
+    return aggregator.finish();
+}
+
+// Same as sum_group_answers but splits |contents| on blank lines, so no group straddles two chunks, and sums
+// the chunks on |pool|. The chunk list and per-chunk sums are allocated from |resource|.
+GroupAnswerCounts sum_group_answers_parallel(std::string_view contents, ThreadPool &pool,
+                                             std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+// Reads groups from |fd| (e.g. stdin or a pipe) until the end of the stream. The aggregator only keeps the current
+// group's masks, so a group may straddle two reads and memory use doesn't grow with the input.
+absl::StatusOr<GroupAnswerCounts> sum_group_answers_streaming(int fd);
+
+#endif // DAY_6_CUSTOM_CUSTOMS_H_
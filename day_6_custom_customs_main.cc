@@ -0,0 +1,89 @@
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "day_6_custom_customs.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+#include "wide_answer_matrix.h"
+
+ABSL_FLAG(int, threads, 1, "Threads to sum groups with, 0 for one per core");
+ABSL_FLAG(bool, wide, false,
+          "Treat every byte of a line as a question code (up to 256 of them) rather than just a-z, and print how many "
+          "groups answered each question");
+ABSL_FLAG(std::string, input, "/home/drew/workspace/advent-of-code/day_6_input.txt", "Input file to solve, - to stream it from stdin");
+
+int main(int argc, char *argv[])
+{
+    absl::ParseCommandLine(argc, argv);
+    std::string filename = absl::GetFlag(FLAGS_input);
+    GroupAnswerCounts counts;
+    if (absl::GetFlag(FLAGS_wide))
+    {
+        // The matrix keeps every person's row, so it needs the whole input rather than a stream
+        if (filename == "-")
+        {
+            std::cerr << "--wide needs an --input file" << std::endl;
+            return -1;
+        }
+        std::cout << "Opening " << filename << std::endl;
+        auto input_file = MappedFile::open(filename);
+        if (!input_file.ok())
+        {
+            std::cerr << input_file.status() << std::endl;
+            return -1;
+        }
+        WideAnswerTotals totals = WideAnswerMatrix::parse(input_file->contents()).sum_group_answers();
+        for (int code = 0; code < kNumQuestionCodes; code++)
+        {
+            if (totals.anyone_per_question[code] > 0)
+            {
+                std::cout << "Question " << code << ": anyone " << totals.anyone_per_question[code] << " everyone "
+                          << totals.everyone_per_question[code] << std::endl;
+            }
+        }
+        counts = totals.counts;
+    }
+    else if (filename == "-")
+    {
+        // A pipe may never fit in memory, so sum the groups as they arrive instead of reading it all first.
+        std::cout << "Streaming stdin" << std::endl;
+        auto streamed_counts = sum_group_answers_streaming(STDIN_FILENO);
+        if (!streamed_counts.ok())
+        {
+            std::cerr << streamed_counts.status() << std::endl;
+            return -1;
+        }
+        counts = *streamed_counts;
+    }
+    else
+    {
+        std::cout << "Opening " << filename << std::endl;
+        auto input_file = MappedFile::open(filename);
+        if (!input_file.ok())
+        {
+            std::cerr << input_file.status() << std::endl;
+            return -1;
+        }
+        if (absl::GetFlag(FLAGS_threads) == 1)
+        {
+            counts = sum_group_answers(input_file->contents());
+        }
+        else
+        {
+            ThreadPool pool(absl::GetFlag(FLAGS_threads));
+            counts = sum_group_answers_parallel(input_file->contents(), pool);
+        }
+    }
+    std::cout << "Num groups: " << counts.num_groups << std::endl;
+    // PART ONE: Anyone answered yes in a group
+    std::cout << "Total answer count(anyone): " << counts.anyone << std::endl;
+    // PART TWO: Everyone answered yes in a group
+    std::cout << "Total answer count (everyone): " << counts.everyone << std::endl;
+
+    return 0;
+}
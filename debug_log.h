@@ -0,0 +1,20 @@
+#ifndef DEBUG_LOG_H_
+#define DEBUG_LOG_H_
+
+// AOC_DEBUG_LOG traces what the parsers and solvers are doing, e.g. how every boarding pass decodes. It is meant
+// for the hot loops, so unless the build defines AOC_ENABLE_DEBUG_LOG (bazel build --copt=-DAOC_ENABLE_DEBUG_LOG)
+// the whole statement, arguments included, compiles away to nothing.
+#if defined(AOC_ENABLE_DEBUG_LOG)
+#include <iostream>
+
+#include "absl/strings/str_format.h"
+
+#define AOC_DEBUG_LOG(...) (std::cerr << absl::StrFormat(__VA_ARGS__) << '\n')
+#else
+#define AOC_DEBUG_LOG(...) \
+    do                     \
+    {                      \
+    } while (false)
+#endif
+
+#endif // DEBUG_LOG_H_
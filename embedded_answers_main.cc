@@ -0,0 +1,37 @@
+// Prints the answers for the inputs checked in next to the code, all of which are computed while compiling: the
+// inputs are embedded by embedded_input() and every parse and solve below is constexpr, so running this costs nothing
+// but the printing. Editing an input rebuilds the answers, and an input that has no answer fails the build.
+// Day 2 still needs the runtime solver since its parse relies on std::from_chars, which isn't constexpr in C++20.
+#include <cstdint>
+#include <iostream>
+
+#include "day_1_embedded_input.h"
+#include "day_1_report_repair.h"
+#include "day_5_binary_boarding.h"
+#include "day_5_embedded_input.h"
+#include "day_6_custom_customs.h"
+#include "day_6_embedded_input.h"
+
+namespace
+{
+
+constexpr auto kDay1Entries = parse_sorted_entry_array<count_entries(kDay1Input)>(kDay1Input);
+constexpr std::optional<int64_t> kDay1PairProduct = pair_product<kEntrySumTarget>(kDay1Entries);
+constexpr std::optional<int64_t> kDay1TripletProduct = triplet_product<kEntrySumTarget>(kDay1Entries);
+static_assert(kDay1PairProduct.has_value() && kDay1TripletProduct.has_value(),
+              "day_1_input.txt has no pair or triplet summing to the target");
+
+constexpr BoardingAnswers kDay5Answers = solve_boarding<DefaultPlane>(kDay5Input);
+
+constexpr GroupAnswerCounts kDay6Counts = sum_group_answers(kDay6Input);
+
+} // namespace
+
+int main()
+{
+    std::cout << "day 1: pair product: " << *kDay1PairProduct << " triplet product: " << *kDay1TripletProduct
+              << "\n";
+    std::cout << "day 5: max seat ID: " << kDay5Answers.max_seat << " my seat: " << kDay5Answers.my_seat << "\n";
+    std::cout << "day 6: anyone: " << kDay6Counts.anyone << " everyone: " << kDay6Counts.everyone << std::endl;
+    return 0;
+}
@@ -0,0 +1,36 @@
+"""Embeds an input file into a generated header so it can be parsed and solved at compile time."""
+
+load("@rules_cc//cc:defs.bzl", "cc_library")
+
+def embedded_input(name, src, variable):
+    """Generates <name>.h declaring the contents of |src| as `inline constexpr std::string_view <variable>`.
+
+    The header is wrapped in a cc_library called |name|. A solver that is constexpr can then compute the
+    answers while compiling, e.g. `constexpr auto counts = sum_group_answers(kDay6Input);`, and the binary
+    just prints constants.
+
+    Args:
+      name: Name of the cc_library, and the generated header's basename.
+      src: The input file to embed.
+      variable: Name of the string_view constant holding the contents.
+    """
+    header = name + ".h"
+    guard = name.upper() + "_H_"
+
+    # A raw string literal keeps the input byte for byte, it just can't contain the closing delimiter.
+    native.genrule(
+        name = name + "_header",
+        srcs = [src],
+        outs = [header],
+        cmd = " && ".join([
+            "if grep -q ')aoc_input\"' $<; then echo '$< contains the raw string delimiter' >&2; exit 1; fi",
+            "(printf '#ifndef %s\\n#define %s\\n\\n#include <string_view>\\n\\n' " + guard + " " + guard,
+            "printf 'inline constexpr std::string_view %s = R\"aoc_input(' " + variable,
+            "cat $<",
+            "printf ')aoc_input\";\\n\\n#endif // %s\\n' " + guard + ") > $@",
+        ]),
+    )
+    cc_library(
+        name = name,
+        hdrs = [header],
+    )
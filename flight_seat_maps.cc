@@ -0,0 +1,119 @@
+#include "flight_seat_maps.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "input_reader.h"
+
+namespace
+{
+
+// Passes are decoded into a small buffer and added a buffer at a time, so the flight lookups stay in a tight loop
+constexpr std::size_t kSeatBufferSize = 4096;
+
+// Parses a "<flight id> <pass>" line. Returns false if it doesn't match.
+bool parse_flight_pass(std::string_view line, FlightSeat &seat)
+{
+    const char *end = line.data() + line.size();
+    auto [space, ec] = std::from_chars(line.data(), end, seat.flight_id);
+    if (ec != std::errc() || space == end || *space != ' ')
+    {
+        return false;
+    }
+    std::string_view pass(space, end - space);
+    pass.remove_prefix(std::min(pass.find_first_not_of(' '), pass.size()));
+    if (pass.size() < kPassChars)
+    {
+        return false;
+    }
+    seat.seat_id = decode_seat_id(pass);
+    return true;
+}
+
+} // namespace
+
+void FlightSeatMaps::add_seats(std::span<const FlightSeat> seats)
+{
+    SeatMap *seat_map = nullptr;
+    uint64_t flight_id = 0;
+    for (const FlightSeat &seat : seats)
+    {
+        if (seat_map == nullptr || seat.flight_id != flight_id)
+        {
+            flight_id = seat.flight_id;
+            seat_map = &map_for(flight_id);
+        }
+        seat_map->mark_occupied(seat.seat_id);
+    }
+}
+
+int64_t FlightSeatMaps::add_passes(std::string_view contents)
+{
+    std::vector<FlightSeat> seats;
+    seats.reserve(kSeatBufferSize);
+    int64_t num_passes = 0;
+    for_each_line(contents, [&](std::string_view line)
+    {
+        FlightSeat seat;
+        if (!parse_flight_pass(line, seat))
+        {
+            return;
+        }
+        seats.push_back(seat);
+        if (seats.size() == kSeatBufferSize)
+        {
+            add_seats(seats);
+            num_passes += seats.size();
+            seats.clear();
+        }
+    });
+    add_seats(seats);
+    return num_passes + seats.size();
+}
+
+int64_t FlightSeatMaps::add_passes(std::string_view contents, ThreadPool &pool)
+{
+    std::pmr::vector<std::string_view> chunks = split_into_chunks(contents, pool.num_threads() * 4, RecordBoundary::kNewline);
+    std::vector<FlightSeatMaps> chunk_maps(chunks.size());
+    std::vector<int64_t> chunk_passes(chunks.size());
+    pool.parallel_for(chunks.size(), [&](std::size_t i) { chunk_passes[i] = chunk_maps[i].add_passes(chunks[i]); });
+    int64_t num_passes = 0;
+    for (std::size_t i = 0; i < chunks.size(); i++)
+    {
+        merge(chunk_maps[i]);
+        num_passes += chunk_passes[i];
+    }
+    return num_passes;
+}
+
+void FlightSeatMaps::merge(const FlightSeatMaps &other)
+{
+    for (std::size_t i = 0; i < other.maps_.size(); i++)
+    {
+        map_for(other.ids_[i]).merge(other.maps_[i]);
+    }
+}
+
+const SeatMap *FlightSeatMaps::find(uint64_t flight_id) const
+{
+    auto it = index_.find(flight_id);
+    return it == index_.end() ? nullptr : &maps_[it->second];
+}
+
+std::vector<uint64_t> FlightSeatMaps::flight_ids() const
+{
+    std::vector<uint64_t> ids = ids_;
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+SeatMap &FlightSeatMaps::map_for(uint64_t flight_id)
+{
+    auto [it, inserted] = index_.try_emplace(flight_id, maps_.size());
+    if (inserted)
+    {
+        ids_.push_back(flight_id);
+        maps_.emplace_back();
+    }
+    return maps_[it->second];
+}
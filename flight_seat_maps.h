@@ -0,0 +1,60 @@
+#ifndef FLIGHT_SEAT_MAPS_H_
+#define FLIGHT_SEAT_MAPS_H_
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "day_5_binary_boarding.h"
+#include "thread_pool.h"
+
+// FlightSeatMaps keeps the occupancy of many flights at once, one SeatMap per flight. A SeatMap is 128 bytes, so
+// thousands of flights stay in cache, and every query is a handful of word operations on one flight's bitmap (see
+// BasicSeatMap) rather than a walk over its passes.
+
+// A decoded boarding pass and the flight it's for
+struct FlightSeat
+{
+    uint64_t flight_id;
+    int seat_id;
+};
+
+class FlightSeatMaps
+{
+public:
+    // Marks every seat in |seats|. Passes for the same flight usually come together, so consecutive seats for the
+    // same flight only look the flight up once.
+    void add_seats(std::span<const FlightSeat> seats);
+
+    // Parses "<flight id> <pass>" lines (e.g. "1042 FBFBBFFRLR") and marks their seats. Lines that don't match are
+    // skipped. Returns the number of passes added.
+    int64_t add_passes(std::string_view contents);
+
+    // Same, but the chunks of |contents| are parsed on |pool| into maps of their own which are merged at the end, so
+    // the workers never share a bitmap.
+    int64_t add_passes(std::string_view contents, ThreadPool &pool);
+
+    // Adds every seat occupied on every flight of |other|
+    void merge(const FlightSeatMaps &other);
+
+    std::size_t num_flights() const { return maps_.size(); }
+
+    // Returns nullptr if there are no passes for |flight_id|
+    const SeatMap *find(uint64_t flight_id) const;
+
+    // The IDs of every flight with passes, in ascending order
+    std::vector<uint64_t> flight_ids() const;
+
+private:
+    SeatMap &map_for(uint64_t flight_id);
+
+    // Index into |maps_| of every flight. The maps themselves are contiguous rather than owned by the hash map, so a
+    // query over every flight is a linear scan.
+    absl::flat_hash_map<uint64_t, std::size_t> index_;
+    std::vector<uint64_t> ids_;
+    std::vector<SeatMap> maps_;
+};
+
+#endif // FLIGHT_SEAT_MAPS_H_
@@ -0,0 +1,81 @@
+// Builds the seat maps of every flight in a file of "<flight id> <pass>" lines and prints one summary line per
+// flight, e.g.
+//   flight-seats --input=passes.txt --run_length=3
+// --flight prints a single flight in detail instead, including how full each row is.
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_format.h"
+#include "day_5_binary_boarding.h"
+#include "flight_seat_maps.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+ABSL_FLAG(std::string, input, "", "File of \"<flight id> <pass>\" lines");
+ABSL_FLAG(int, threads, 1, "Threads to decode passes with, 0 for one per core");
+ABSL_FLAG(int, run_length, 3, "Count runs of this many free seats in a row, e.g. to seat a group together");
+ABSL_FLAG(int64_t, flight, -1, "Only print this flight, in detail");
+
+int main(int argc, char *argv[])
+{
+    absl::ParseCommandLine(argc, argv);
+    int run_length = absl::GetFlag(FLAGS_run_length);
+    if (run_length < 1 || run_length > kNumCols)
+    {
+        std::cerr << "--run_length must be between 1 and " << kNumCols << std::endl;
+        return -1;
+    }
+    auto input_file = MappedFile::open(absl::GetFlag(FLAGS_input));
+    if (!input_file.ok())
+    {
+        std::cerr << input_file.status() << std::endl;
+        return -1;
+    }
+    FlightSeatMaps flights;
+    ThreadPool pool(absl::GetFlag(FLAGS_threads));
+    int64_t num_passes = pool.num_threads() == 1 ? flights.add_passes(input_file->contents())
+                                                 : flights.add_passes(input_file->contents(), pool);
+    std::cout << "Read " << num_passes << " passes for " << flights.num_flights() << " flights" << std::endl;
+
+    if (absl::GetFlag(FLAGS_flight) >= 0)
+    {
+        const SeatMap *seat_map = flights.find(absl::GetFlag(FLAGS_flight));
+        if (seat_map == nullptr)
+        {
+            std::cerr << "no passes for flight " << absl::GetFlag(FLAGS_flight) << std::endl;
+            return -1;
+        }
+        std::cout << "Occupied seats: " << seat_map->num_occupied() << std::endl;
+        std::cout << "Max seat ID: " << seat_map->max_occupied_seat() << std::endl;
+        std::cout << "Isolated free seats:";
+        SeatMap::for_each_seat(seat_map->isolated_free_bits(), [](int seat) { std::cout << " " << seat; });
+        std::cout << std::endl;
+        std::cout << "Free runs of " << run_length << " start at:";
+        SeatMap::for_each_seat(seat_map->free_run_bits(run_length), [](int seat) { std::cout << " " << seat; });
+        std::cout << std::endl;
+        std::array<int, kNumRows> occupancy = seat_map->row_occupancy();
+        for (int row = 0; row < kNumRows; row++)
+        {
+            std::cout << absl::StrFormat("Row %3d: %d/%d", row, occupancy[row], kNumCols) << std::endl;
+        }
+        return 0;
+    }
+
+    // Buffered since there can be thousands of flights
+    std::string summary;
+    for (uint64_t flight_id : flights.flight_ids())
+    {
+        const SeatMap &seat_map = *flights.find(flight_id);
+        SeatMap::Bits isolated = seat_map.isolated_free_bits();
+        absl::StrAppendFormat(&summary, "flight %d: occupied %d max seat %d isolated free %d free runs of %d: %d\n",
+                              flight_id, seat_map.num_occupied(), seat_map.max_occupied_seat(),
+                              SeatMap::count_seats(isolated), run_length,
+                              SeatMap::count_seats(seat_map.free_run_bits(run_length)));
+    }
+    std::cout << summary << std::flush;
+    return 0;
+}
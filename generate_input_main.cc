@@ -0,0 +1,38 @@
+// Writes a synthetic input for one of the days to stdout, e.g.
+//   bazel run :generate-input -- 5 1000000000 > /tmp/day_5_huge.txt
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "input_generators.h"
+
+// Parses all of |arg| into |value|, returns false if it isn't entirely a number
+template <typename T>
+bool parse_arg(const char *arg, T &value)
+{
+    const char *end = arg + std::strlen(arg);
+    auto [ptr, ec] = std::from_chars(arg, end, value);
+    return ec == std::errc() && ptr == end && ptr != arg;
+}
+
+int main(int argc, char const *argv[])
+{
+    int day = 0;
+    int64_t num_records = 0;
+    uint64_t seed = 2020;
+    if (argc < 3 || !parse_arg(argv[1], day) || !parse_arg(argv[2], num_records) || num_records < 0 ||
+        (argc > 3 && !parse_arg(argv[3], seed)))
+    {
+        std::cerr << "usage: " << argv[0] << " <day> <num_records> [seed]" << std::endl;
+        return -1;
+    }
+    std::ios_base::sync_with_stdio(false);
+    auto status = generate_input(day, std::cout, num_records, seed);
+    if (!status.ok())
+    {
+        std::cerr << status << std::endl;
+        return -1;
+    }
+    return 0;
+}
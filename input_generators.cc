@@ -0,0 +1,247 @@
+#include "input_generators.h"
+
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <sstream>
+
+#include "absl/strings/str_format.h"
+
+namespace
+{
+
+// Going through operator<< for every value is far too slow for 10^9 records, so the generators build
+// their output in a buffer and only hand it to the stream once it fills up.
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(std::ostream &out) : out_(out) { buffer_.reserve(kFlushSize + 64); }
+    ~BufferedWriter() { flush(); }
+
+    void put(char c)
+    {
+        buffer_.push_back(c);
+        maybe_flush();
+    }
+
+    void put(std::string_view s)
+    {
+        buffer_.append(s);
+        maybe_flush();
+    }
+
+    void put_int(int64_t value)
+    {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        put(std::string_view(digits, result.ptr - digits));
+    }
+
+private:
+    static constexpr std::size_t kFlushSize = 1 << 20;
+
+    void maybe_flush()
+    {
+        if (buffer_.size() >= kFlushSize)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        out_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+    std::ostream &out_;
+    std::string buffer_;
+};
+
+int64_t uniform(std::mt19937_64 &rng, int64_t min, int64_t max)
+{
+    return std::uniform_int_distribution<int64_t>(min, max)(rng);
+}
+
+// Whether |planted| has exactly one pair and one triplet (by position) that sum to 2020
+bool has_unique_answers(const std::vector<int64_t> &planted)
+{
+    int num_pairs = 0;
+    int num_triplets = 0;
+    for (std::size_t i = 0; i < planted.size(); i++)
+    {
+        for (std::size_t j = i + 1; j < planted.size(); j++)
+        {
+            num_pairs += planted[i] + planted[j] == 2020;
+            for (std::size_t k = j + 1; k < planted.size(); k++)
+            {
+                num_triplets += planted[i] + planted[j] + planted[k] == 2020;
+            }
+        }
+    }
+    return num_pairs == 1 && num_triplets == 1;
+}
+
+} // namespace
+
+void generate_day_1_input(std::ostream &out, int64_t num_records, uint64_t seed, int max_value)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<int64_t> planted;
+    // Need room for the pair and the triplet, smaller inputs are just random. The filler is all above 2020 so it
+    // can't be part of an answer, but the planted values could still make a second pair or triplet between them
+    // (e.g. a pair value plus two of the triplet's), so draw again until they don't.
+    while (num_records >= 5 && (planted.empty() || !has_unique_answers(planted)))
+    {
+        int64_t pair_first = uniform(rng, 1, 2019);
+        int64_t triplet_first = uniform(rng, 1, 2018);
+        int64_t triplet_second = uniform(rng, 1, 2019 - triplet_first);
+        planted = {pair_first, 2020 - pair_first, triplet_first, triplet_second, 2020 - triplet_first - triplet_second};
+    }
+    std::vector<int64_t> planted_at;
+    while (planted_at.size() < planted.size())
+    {
+        int64_t pos = uniform(rng, 0, num_records - 1);
+        if (std::find(planted_at.begin(), planted_at.end(), pos) == planted_at.end())
+        {
+            planted_at.push_back(pos);
+        }
+    }
+    BufferedWriter writer(out);
+    for (int64_t i = 0; i < num_records; i++)
+    {
+        auto planted_it = std::find(planted_at.begin(), planted_at.end(), i);
+        writer.put_int(planted_it != planted_at.end() ? planted[planted_it - planted_at.begin()]
+                                                      : uniform(rng, 2021, std::max(max_value, 2021)));
+        writer.put('\n');
+    }
+}
+
+void generate_day_2_input(std::ostream &out, int64_t num_records, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    BufferedWriter writer(out);
+    std::string pw;
+    for (int64_t i = 0; i < num_records; i++)
+    {
+        int64_t first = uniform(rng, 1, 19);
+        int64_t second = uniform(rng, first + 1, 20);
+        char letter = 'a' + uniform(rng, 0, 25);
+        // Real passwords lean heavily on the policy letter, otherwise almost nothing would be valid
+        pw.resize(uniform(rng, 1, 20));
+        for (char &c : pw)
+        {
+            c = uniform(rng, 0, 2) == 0 ? letter : 'a' + uniform(rng, 0, 25);
+        }
+        writer.put_int(first);
+        writer.put('-');
+        writer.put_int(second);
+        writer.put(' ');
+        writer.put(letter);
+        writer.put(": ");
+        writer.put(pw);
+        writer.put('\n');
+    }
+}
+
+void generate_day_5_input(std::ostream &out, int64_t num_records, uint64_t seed)
+{
+    constexpr int kNumSeats = 1024;
+    std::mt19937_64 rng(seed);
+    // Like the real puzzle, the passes fill a contiguous range of seats except for one in the middle, which is the
+    // answer to part two. A plane only has 1023 such seats, so a bigger input is made of several shuffles of the
+    // same seats: seat IDs repeat between them, but never within one, and the free seat is the same throughout.
+    std::vector<int> seats;
+    if (num_records < 2)
+    {
+        // No room for a free seat with occupied neighbours
+        seats.push_back(uniform(rng, 0, kNumSeats - 1));
+    }
+    else
+    {
+        int64_t range_size = std::min<int64_t>(num_records + 1, kNumSeats);
+        int64_t first_seat = uniform(rng, 0, kNumSeats - range_size);
+        int64_t free_seat = uniform(rng, first_seat + 1, first_seat + range_size - 2);
+        for (int64_t seat = first_seat; seat < first_seat + range_size; seat++)
+        {
+            if (seat != free_seat)
+            {
+                seats.push_back(seat);
+            }
+        }
+    }
+    BufferedWriter writer(out);
+    for (int64_t i = 0; i < num_records; i++)
+    {
+        std::size_t next = i % seats.size();
+        if (next == 0)
+        {
+            std::shuffle(seats.begin(), seats.end(), rng);
+        }
+        // The first character is the most significant bit of the seat ID
+        for (int pass_char = 0; pass_char < 10; pass_char++)
+        {
+            bool bit = (seats[next] >> (9 - pass_char)) & 1;
+            writer.put(pass_char < 7 ? (bit ? 'B' : 'F') : (bit ? 'R' : 'L'));
+        }
+        writer.put('\n');
+    }
+}
+
+void generate_day_6_input(std::ostream &out, int64_t num_records, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    BufferedWriter writer(out);
+    int64_t people_left_in_group = uniform(rng, 1, 5);
+    for (int64_t i = 0; i < num_records; i++)
+    {
+        if (people_left_in_group == 0)
+        {
+            writer.put('\n');
+            people_left_in_group = uniform(rng, 1, 5);
+        }
+        // Every person answers yes to at least one question, each question at most once
+        uint32_t answers = static_cast<uint32_t>(rng()) & ((1u << 26) - 1);
+        if (answers == 0)
+        {
+            answers = 1;
+        }
+        for (int question = 0; question < 26; question++)
+        {
+            if ((answers >> question) & 1)
+            {
+                writer.put(static_cast<char>('a' + question));
+            }
+        }
+        writer.put('\n');
+        people_left_in_group--;
+    }
+}
+
+absl::Status generate_input(int day, std::ostream &out, int64_t num_records, uint64_t seed)
+{
+    switch (day)
+    {
+    case 1:
+        generate_day_1_input(out, num_records, seed);
+        return absl::OkStatus();
+    case 2:
+        generate_day_2_input(out, num_records, seed);
+        return absl::OkStatus();
+    case 5:
+        generate_day_5_input(out, num_records, seed);
+        return absl::OkStatus();
+    case 6:
+        generate_day_6_input(out, num_records, seed);
+        return absl::OkStatus();
+    default:
+        return absl::InvalidArgumentError(absl::StrFormat("no input generator for day %d", day));
+    }
+}
+
+std::string generate_input_string(int day, int64_t num_records, uint64_t seed)
+{
+    std::ostringstream out;
+    generate_input(day, out, num_records, seed).IgnoreError();
+    return out.str();
+}
@@ -0,0 +1,35 @@
+#ifndef INPUT_GENERATORS_H_
+#define INPUT_GENERATORS_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "absl/status/status.h"
+
+// Generators for synthetic inputs in exactly the same format as each day's puzzle input, so the solvers can be
+// run at sizes way past the checked in day_*_input.txt files. The same |seed| always produces the same input.
+// A record is one line, except for day 6 where a record is one person's answers (groups are 1 to 5 people).
+
+// One integer per line. All entries are in [2021, |max_value|] except for one planted pair and one planted
+// triplet that sum to 2020, so there is exactly one answer to find for each part, same as the real puzzle.
+// Inputs of less than 5 records have no room for them and are all filler.
+void generate_day_1_input(std::ostream &out, int64_t num_records, uint64_t seed, int max_value = 1 << 30);
+
+// "N-M l: pw" lines
+void generate_day_2_input(std::ostream &out, int64_t num_records, uint64_t seed);
+
+// 10 character F/B/L/R boarding passes for a contiguous range of seats with one free seat in the middle. Seat IDs
+// are unique up to 1023 records, a full plane minus the free seat, after which the same seats are shuffled again.
+void generate_day_5_input(std::ostream &out, int64_t num_records, uint64_t seed);
+
+// Lines of a-z answers with a blank line between groups
+void generate_day_6_input(std::ostream &out, int64_t num_records, uint64_t seed);
+
+// Dispatches to the generator for |day|, or returns an error if there isn't one.
+absl::Status generate_input(int day, std::ostream &out, int64_t num_records, uint64_t seed);
+
+// Same as generate_input but returns the input in memory, for benchmarks.
+std::string generate_input_string(int day, int64_t num_records, uint64_t seed);
+
+#endif // INPUT_GENERATORS_H_
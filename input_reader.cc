@@ -0,0 +1,161 @@
+#include "input_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+
+absl::StatusOr<MappedFile> MappedFile::open(std::string_view filename)
+{
+    std::string path(filename);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return absl::NotFoundError(absl::StrFormat("unable to open %s: %s", path, std::strerror(errno)));
+    }
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0)
+    {
+        int fstat_errno = errno;
+        ::close(fd);
+        return absl::InternalError(absl::StrFormat("unable to stat %s: %s", path, std::strerror(fstat_errno)));
+    }
+    std::size_t size = file_stat.st_size;
+    // mmap refuses zero length mappings, an empty file is just an empty view.
+    if (size == 0)
+    {
+        ::close(fd);
+        return MappedFile(nullptr, 0);
+    }
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int mmap_errno = errno;
+    // The mapping keeps its own reference to the file so the descriptor isn't needed anymore.
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return absl::InternalError(absl::StrFormat("unable to mmap %s: %s", path, std::strerror(mmap_errno)));
+    }
+    // All the days walk their input front to back exactly once, let the kernel read ahead aggressively.
+    ::madvise(data, size, MADV_SEQUENTIAL);
+    return MappedFile(static_cast<const char *>(data), size);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+void MappedFile::unmap()
+{
+    if (data_ != nullptr)
+    {
+        ::munmap(const_cast<char *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+LineStreamReader::LineStreamReader(int fd, std::size_t buffer_size) : fd_(fd), buffer_(std::max<std::size_t>(buffer_size, 1)) {}
+
+absl::StatusOr<bool> LineStreamReader::next_block(std::string_view &block)
+{
+    // Move the partial line left over from the last block to the front so the rest of the buffer can be refilled.
+    std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+    // The leftover can't contain a newline, only the newly read bytes need to be searched
+    std::size_t scanned = end_;
+    while (!eof_ && std::memchr(buffer_.data() + scanned, '\n', end_ - scanned) == nullptr)
+    {
+        scanned = end_;
+        if (end_ == buffer_.size())
+        {
+            // A single line longer than the whole buffer
+            buffer_.resize(buffer_.size() * 2);
+        }
+        // A pipe returns whatever has been written so far, so a block is handed out as soon as it holds a whole
+        // line rather than waiting for the buffer to fill up.
+        ssize_t bytes_read = ::read(fd_, buffer_.data() + end_, buffer_.size() - end_);
+        if (bytes_read < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return absl::InternalError(absl::StrFormat("unable to read stream: %s", std::strerror(errno)));
+        }
+        if (bytes_read == 0)
+        {
+            eof_ = true;
+        }
+        end_ += bytes_read;
+    }
+    if (end_ == 0)
+    {
+        return false;
+    }
+    std::size_t block_end = end_;
+    if (!eof_)
+    {
+        // Stop just past the last newline, the rest is the start of a line that is still being written.
+        const char *last_newline = static_cast<const char *>(::memrchr(buffer_.data(), '\n', end_));
+        block_end = last_newline - buffer_.data() + 1;
+    }
+    block = std::string_view(buffer_.data(), block_end);
+    begin_ = block_end;
+    return true;
+}
+
+std::vector<std::string_view> read_lines(std::string_view contents)
+{
+    std::vector<std::string_view> lines;
+    for_each_line(contents, [&lines](std::string_view line) { lines.push_back(line); });
+    return lines;
+}
+
+std::pmr::vector<std::string_view> split_into_chunks(std::string_view contents, std::size_t num_chunks,
+                                                     RecordBoundary boundary, std::pmr::memory_resource *resource)
+{
+    std::pmr::vector<std::string_view> chunks(resource);
+    num_chunks = std::max<std::size_t>(num_chunks, 1);
+    chunks.reserve(num_chunks);
+    std::size_t target_size = contents.size() / num_chunks + 1;
+    std::string_view separator = boundary == RecordBoundary::kNewline ? "\n" : "\n\n";
+    std::size_t chunk_start = 0;
+    while (chunk_start < contents.size())
+    {
+        std::size_t chunk_end = contents.size();
+        if (chunk_start + target_size < contents.size())
+        {
+            // Move the end forward to just past the next separator
+            std::size_t separator_pos = contents.find(separator, chunk_start + target_size);
+            if (separator_pos != std::string_view::npos)
+            {
+                chunk_end = separator_pos + separator.size();
+            }
+        }
+        chunks.push_back(contents.substr(chunk_start, chunk_end - chunk_start));
+        chunk_start = chunk_end;
+    }
+    return chunks;
+}
@@ -0,0 +1,169 @@
+#ifndef INPUT_READER_H_
+#define INPUT_READER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+// MappedFile maps an input file read-only into memory. Every day used to read its input through
+// std::ifstream and getline, which allocates a std::string for every line. Instead, the days can
+// hand out std::string_view lines that point straight into the mapping, as long as the MappedFile
+// outlives them.
+class MappedFile
+{
+public:
+    static absl::StatusOr<MappedFile> open(std::string_view filename);
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    std::string_view contents() const { return std::string_view(data_, size_); }
+
+private:
+    MappedFile(const char *data, std::size_t size) : data_(data), size_(size){};
+    void unmap();
+
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// LineStreamReader reads a stream that can't be mapped (stdin, a pipe, a socket) through one fixed size buffer
+// that is reused for the whole stream, so memory use doesn't depend on how large the input is. It hands out the
+// complete lines in the buffer a block at a time and carries a partial line over to the next read. The buffer only
+// grows if a single line doesn't fit in it.
+class LineStreamReader
+{
+public:
+    static constexpr std::size_t kDefaultBufferSize = 1 << 20;
+
+    // |fd| is not owned and must stay open while reading.
+    explicit LineStreamReader(int fd, std::size_t buffer_size = kDefaultBufferSize);
+
+    // Sets |block| to the next run of complete lines, including the newline after the last one (except at the
+    // very end of a stream that doesn't end with a newline). |block| stays valid until the next call. Returns
+    // false once the stream is exhausted.
+    absl::StatusOr<bool> next_block(std::string_view &block);
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+    // The unconsumed bytes are buffer_[begin_, end_)
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    bool eof_ = false;
+};
+
+// Calls |block_fn| with every block of complete lines read from |fd| until the end of the stream. Since a block
+// never ends mid line, each one can go through the same parsers as a mapped file, e.g. for_each_line.
+template <typename BlockFn>
+absl::Status for_each_streamed_block(int fd, BlockFn block_fn)
+{
+    LineStreamReader reader(fd);
+    std::string_view block;
+    while (true)
+    {
+        absl::StatusOr<bool> has_block = reader.next_block(block);
+        if (!has_block.ok())
+        {
+            return has_block.status();
+        }
+        if (!*has_block)
+        {
+            return absl::OkStatus();
+        }
+        block_fn(block);
+    }
+}
+
+// Calls |line_fn| with every line in |contents|, without the trailing newline. A trailing newline at
+// the very end of |contents| does not produce an extra empty line (same as getline).
+// This also runs at compile time, e.g. to parse an input embedded with embedded_input().
+template <typename LineFn>
+constexpr void for_each_line(std::string_view contents, LineFn line_fn)
+{
+    if (std::is_constant_evaluated())
+    {
+        std::size_t pos = 0;
+        while (pos < contents.size())
+        {
+            std::size_t line_end = std::min(contents.find('\n', pos), contents.size());
+            line_fn(contents.substr(pos, line_end - pos));
+            pos = line_end + 1;
+        }
+        return;
+    }
+    const char *cur = contents.data();
+    const char *end = cur + contents.size();
+    while (cur < end)
+    {
+        // memchr is vectorized by libc, which is a lot faster than checking a byte at a time.
+        const char *newline = static_cast<const char *>(std::memchr(cur, '\n', end - cur));
+        const char *line_end = newline == nullptr ? end : newline;
+        line_fn(std::string_view(cur, line_end - cur));
+        cur = line_end + 1;
+    }
+}
+
+// Calls |record_fn| with every record in |contents|, where records are separated by blank lines
+// (e.g. the groups in day 6). Each record still contains the newlines between its own lines but not
+// the trailing one.
+template <typename RecordFn>
+void for_each_record(std::string_view contents, RecordFn record_fn)
+{
+    std::size_t record_start = std::string_view::npos;
+    std::size_t pos = 0;
+    for_each_line(contents, [&](std::string_view line) {
+        std::size_t line_start = line.data() - contents.data();
+        if (line.empty())
+        {
+            if (record_start != std::string_view::npos)
+            {
+                record_fn(contents.substr(record_start, pos - record_start));
+                record_start = std::string_view::npos;
+            }
+        }
+        else
+        {
+            if (record_start == std::string_view::npos)
+            {
+                record_start = line_start;
+            }
+            pos = line_start + line.size();
+        }
+    });
+    if (record_start != std::string_view::npos)
+    {
+        record_fn(contents.substr(record_start, pos - record_start));
+    }
+}
+
+// What separates the records of an input, so chunks never split one in half.
+enum class RecordBoundary
+{
+    // One record per line (days 1, 2 and 5)
+    kNewline,
+    // Records are groups of lines separated by a blank line (day 6)
+    kBlankLine,
+};
+
+// Splits |contents| into at most |num_chunks| pieces of roughly equal size that each start and end on a
+// record boundary, so they can be parsed independently (e.g. on different threads). Empty chunks are dropped.
+// The list is allocated from |resource|, e.g. the runner's per-job arena.
+std::pmr::vector<std::string_view> split_into_chunks(std::string_view contents, std::size_t num_chunks,
+                                                     RecordBoundary boundary,
+                                                     std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+// Convenience for the days that want random access to their lines. The views point into |contents|.
+std::vector<std::string_view> read_lines(std::string_view contents);
+
+#endif // INPUT_READER_H_
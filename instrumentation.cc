@@ -0,0 +1,271 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+#include "absl/strings/str_format.h"
+
+namespace
+{
+
+// Relaxed is enough, the counts are only read between phases and don't order anything.
+std::atomic<int64_t> g_allocation_count{0};
+std::atomic<int64_t> g_allocated_bytes{0};
+
+void count_allocation(std::size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void *counted_malloc(std::size_t size)
+{
+    count_allocation(size);
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *counted_aligned_malloc(std::size_t size, std::align_val_t alignment)
+{
+    count_allocation(size);
+    void *ptr = nullptr;
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+    if (::posix_memalign(&ptr, align, size == 0 ? 1 : size) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+#if defined(__linux__)
+constexpr std::array<uint64_t, 4> kCounterConfigs = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+int open_counter(uint64_t config, int group_fd)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // Only the leader starts disabled, the rest of the group follows it
+    attr.disabled = group_fd == -1;
+    // User space only, which also keeps it working with perf_event_paranoid=2
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+#endif
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+void *operator new(std::size_t size) { return counted_malloc(size); }
+void *operator new[](std::size_t size) { return counted_malloc(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return counted_aligned_malloc(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return counted_aligned_malloc(size, alignment); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+int64_t allocation_count() { return g_allocation_count.load(std::memory_order_relaxed); }
+int64_t allocated_bytes() { return g_allocated_bytes.load(std::memory_order_relaxed); }
+
+PhaseProfiler::PhaseProfiler()
+{
+    counter_fds_.fill(-1);
+#if defined(__linux__)
+    for (std::size_t i = 0; i < kCounterConfigs.size(); i++)
+    {
+        counter_fds_[i] = open_counter(kCounterConfigs[i], i == 0 ? -1 : counter_fds_[0]);
+        if (counter_fds_[i] < 0)
+        {
+            // All or nothing, a partial group would make the JSON misleading
+            for (int &fd : counter_fds_)
+            {
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+                fd = -1;
+            }
+            return;
+        }
+    }
+    ::ioctl(counter_fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(counter_fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+PhaseProfiler::~PhaseProfiler()
+{
+#if defined(__linux__)
+    for (int fd : counter_fds_)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+#endif
+}
+
+std::optional<HardwareCounters> PhaseProfiler::read_counters() const
+{
+#if defined(__linux__)
+    if (counter_fds_[0] < 0)
+    {
+        return std::nullopt;
+    }
+    // PERF_FORMAT_GROUP reads the number of counters followed by each value in the order they were opened
+    struct
+    {
+        uint64_t num_counters;
+        uint64_t values[kCounterConfigs.size()];
+    } group;
+    if (::read(counter_fds_[0], &group, sizeof(group)) != sizeof(group) || group.num_counters != kCounterConfigs.size())
+    {
+        return std::nullopt;
+    }
+    return HardwareCounters{
+        .cycles = static_cast<int64_t>(group.values[0]),
+        .instructions = static_cast<int64_t>(group.values[1]),
+        .cache_misses = static_cast<int64_t>(group.values[2]),
+        .branch_misses = static_cast<int64_t>(group.values[3]),
+    };
+#else
+    return std::nullopt;
+#endif
+}
+
+PhaseProfiler::Snapshot PhaseProfiler::take_snapshot() const
+{
+    // Read the counters first so the clock and allocation reads aren't counted as part of the phase
+    std::optional<HardwareCounters> counters = read_counters();
+    return Snapshot{now_ns(), allocation_count(), allocated_bytes(), counters};
+}
+
+void PhaseProfiler::begin_phase(std::string_view name)
+{
+    end_phase();
+    phase_name_ = std::string(name);
+    in_phase_ = true;
+    phase_start_ = take_snapshot();
+}
+
+void PhaseProfiler::end_phase()
+{
+    if (!in_phase_)
+    {
+        return;
+    }
+    Snapshot phase_end = take_snapshot();
+    in_phase_ = false;
+    PhaseStats stats;
+    stats.name = std::move(phase_name_);
+    stats.wall_ns = phase_end.time_ns - phase_start_.time_ns;
+    stats.allocations = phase_end.allocations - phase_start_.allocations;
+    stats.allocated_bytes = phase_end.allocated_bytes - phase_start_.allocated_bytes;
+    if (phase_start_.counters && phase_end.counters)
+    {
+        stats.counters = HardwareCounters{
+            .cycles = phase_end.counters->cycles - phase_start_.counters->cycles,
+            .instructions = phase_end.counters->instructions - phase_start_.counters->instructions,
+            .cache_misses = phase_end.counters->cache_misses - phase_start_.counters->cache_misses,
+            .branch_misses = phase_end.counters->branch_misses - phase_start_.counters->branch_misses,
+        };
+    }
+    phases_.push_back(std::move(stats));
+}
+
+std::string PhaseProfiler::to_json() const
+{
+    std::string json = "[";
+    for (std::size_t i = 0; i < phases_.size(); i++)
+    {
+        const PhaseStats &phase = phases_[i];
+        absl::StrAppendFormat(&json, "%s{\"name\": %s, \"wall_ns\": %d, \"allocations\": %d, \"allocated_bytes\": %d, ",
+                              i == 0 ? "" : ", ", json_quote(phase.name), phase.wall_ns, phase.allocations,
+                              phase.allocated_bytes);
+        if (phase.counters)
+        {
+            absl::StrAppendFormat(&json,
+                                  "\"counters\": {\"cycles\": %d, \"instructions\": %d, \"cache_misses\": %d, "
+                                  "\"branch_misses\": %d}}",
+                                  phase.counters->cycles, phase.counters->instructions, phase.counters->cache_misses,
+                                  phase.counters->branch_misses);
+        }
+        else
+        {
+            json += "\"counters\": null}";
+        }
+    }
+    json += "]";
+    return json;
+}
+
+std::string json_quote(std::string_view s)
+{
+    std::string quoted = "\"";
+    for (char c : s)
+    {
+        switch (c)
+        {
+        case '"':
+            quoted += "\\\"";
+            break;
+        case '\\':
+            quoted += "\\\\";
+            break;
+        case '\n':
+            quoted += "\\n";
+            break;
+        case '\t':
+            quoted += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                absl::StrAppendFormat(&quoted, "\\u%04x", static_cast<unsigned char>(c));
+            }
+            else
+            {
+                quoted += c;
+            }
+        }
+    }
+    quoted += "\"";
+    return quoted;
+}
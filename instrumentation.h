@@ -0,0 +1,106 @@
+#ifndef INSTRUMENTATION_H_
+#define INSTRUMENTATION_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Every allocation made through global operator new since the process started. Linking the instrumentation
+// library replaces operator new/delete with versions that keep these counts.
+int64_t allocation_count();
+int64_t allocated_bytes();
+
+// The hardware counters collected for a phase, see PhaseProfiler.
+struct HardwareCounters
+{
+    int64_t cycles = 0;
+    int64_t instructions = 0;
+    int64_t cache_misses = 0;
+    int64_t branch_misses = 0;
+};
+
+struct PhaseStats
+{
+    std::string name;
+    int64_t wall_ns = 0;
+    int64_t allocations = 0;
+    int64_t allocated_bytes = 0;
+    // Missing if perf_event_open isn't available (not Linux, no PMU, or perf_event_paranoid forbids it)
+    std::optional<HardwareCounters> counters;
+};
+
+// PhaseProfiler records the wall time, allocations and (on Linux) hardware counters of each phase of a run,
+// e.g. read, parse, solve and output. Phases don't nest, beginning a phase ends the current one.
+// The hardware counters only cover the thread that created the profiler, so with a thread pool they measure the
+// caller's share of the work while the wall time covers everything.
+class PhaseProfiler
+{
+public:
+    PhaseProfiler();
+    ~PhaseProfiler();
+
+    PhaseProfiler(const PhaseProfiler &) = delete;
+    PhaseProfiler &operator=(const PhaseProfiler &) = delete;
+
+    void begin_phase(std::string_view name);
+    void end_phase();
+
+    const std::vector<PhaseStats> &phases() const { return phases_; }
+
+    // The finished phases as a JSON array of objects, in the order they ran.
+    std::string to_json() const;
+
+private:
+    struct Snapshot
+    {
+        int64_t time_ns;
+        int64_t allocations;
+        int64_t allocated_bytes;
+        std::optional<HardwareCounters> counters;
+    };
+
+    Snapshot take_snapshot() const;
+    std::optional<HardwareCounters> read_counters() const;
+
+    // perf_event_open descriptors, the first is the group leader. -1 if unavailable.
+    std::array<int, 4> counter_fds_;
+    bool in_phase_ = false;
+    std::string phase_name_;
+    Snapshot phase_start_{};
+    std::vector<PhaseStats> phases_;
+};
+
+// Returns |s| as a quoted JSON string.
+std::string json_quote(std::string_view s);
+
+// Times the enclosing scope as one phase of |profiler|. A null profiler does nothing, so code can be instrumented
+// unconditionally and only pay for it when profiling was asked for.
+class ScopedPhase
+{
+public:
+    ScopedPhase(PhaseProfiler *profiler, std::string_view name) : profiler_(profiler)
+    {
+        if (profiler_ != nullptr)
+        {
+            profiler_->begin_phase(name);
+        }
+    }
+    ~ScopedPhase()
+    {
+        if (profiler_ != nullptr)
+        {
+            profiler_->end_phase();
+        }
+    }
+
+    ScopedPhase(const ScopedPhase &) = delete;
+    ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+private:
+    PhaseProfiler *profiler_;
+};
+
+#endif // INSTRUMENTATION_H_
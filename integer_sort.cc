@@ -0,0 +1,198 @@
+#include "integer_sort.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace
+{
+
+// Below this std::sort's insertion sort beats the fixed cost of the histograms
+constexpr std::size_t kSmallSortSize = 256;
+// Don't let a counting sort's counts outgrow the L2 cache, even when there are lots of values
+constexpr uint64_t kMaxCountingRange = uint64_t{1} << 20;
+// Splitting a radix pass over threads only pays off once each thread gets a decent chunk
+constexpr std::size_t kMinParallelSize = std::size_t{1} << 16;
+
+constexpr int kRadixBits = 8;
+constexpr int kNumBuckets = 1 << kRadixBits;
+constexpr int kNumPasses = 32 / kRadixBits;
+
+using Histogram = std::array<std::size_t, kNumBuckets>;
+
+// The radix sort works on each value's offset from |min|. As an unsigned 32-bit number that keeps the order of the
+// ints, negative ones included, and leaves the high bytes zero when the range is narrow.
+inline uint32_t radix_key(int value, int min) { return static_cast<uint32_t>(value) - static_cast<uint32_t>(min); }
+
+inline int radix_digit(int value, int min, int pass)
+{
+    return (radix_key(value, min) >> (pass * kRadixBits)) & (kNumBuckets - 1);
+}
+
+void counting_sort(std::span<int> values, int min, uint32_t range, std::pmr::memory_resource *scratch_resource)
+{
+    std::pmr::vector<std::size_t> counts(std::size_t{range} + 1, scratch_resource);
+    for (int value : values)
+    {
+        counts[radix_key(value, min)]++;
+    }
+    auto out = values.begin();
+    for (uint32_t key = 0; key <= range; key++)
+    {
+        out = std::fill_n(out, counts[key], static_cast<int>(static_cast<uint32_t>(min) + key));
+    }
+}
+
+// Only the passes that change something are run: a byte that is the same in every value (e.g. all the high bytes
+// of a narrow range) would just copy everything across.
+bool pass_is_trivial(const Histogram &histogram, std::size_t num_values)
+{
+    return std::find(histogram.begin(), histogram.end(), num_values) != histogram.end();
+}
+
+void radix_sort(std::span<int> values, int min, int num_passes, std::pmr::memory_resource *scratch_resource)
+{
+    // Every pass' histogram comes from the same read of the input, they don't depend on the order.
+    std::array<Histogram, kNumPasses> histograms{};
+    for (int value : values)
+    {
+        for (int pass = 0; pass < num_passes; pass++)
+        {
+            histograms[pass][radix_digit(value, min, pass)]++;
+        }
+    }
+    std::pmr::vector<int> scratch(values.size(), scratch_resource);
+    std::span<int> from = values;
+    std::span<int> to = scratch;
+    for (int pass = 0; pass < num_passes; pass++)
+    {
+        if (pass_is_trivial(histograms[pass], values.size()))
+        {
+            continue;
+        }
+        Histogram offsets;
+        std::size_t offset = 0;
+        for (int bucket = 0; bucket < kNumBuckets; bucket++)
+        {
+            offsets[bucket] = offset;
+            offset += histograms[pass][bucket];
+        }
+        for (int value : from)
+        {
+            to[offsets[radix_digit(value, min, pass)]++] = value;
+        }
+        std::swap(from, to);
+    }
+    if (from.data() != values.data())
+    {
+        std::copy(from.begin(), from.end(), values.begin());
+    }
+}
+
+void parallel_radix_sort(std::span<int> values, int min, int num_passes, ThreadPool &pool,
+                         std::pmr::memory_resource *scratch_resource)
+{
+    // One chunk per thread, and the scatter has to see the chunks in order to keep each pass stable.
+    std::size_t num_chunks = pool.num_threads();
+    std::size_t chunk_size = (values.size() + num_chunks - 1) / num_chunks;
+    // Allocated up front on this thread, the tasks only write into them
+    std::pmr::vector<Histogram> chunk_histograms(num_chunks, scratch_resource);
+    std::pmr::vector<int> scratch(values.size(), scratch_resource);
+    std::span<int> from = values;
+    std::span<int> to = scratch;
+    auto chunk_of = [&](std::span<int> span, std::size_t chunk)
+    {
+        std::size_t begin = std::min(chunk * chunk_size, span.size());
+        return span.subspan(begin, std::min(chunk_size, span.size() - begin));
+    };
+    for (int pass = 0; pass < num_passes; pass++)
+    {
+        pool.parallel_for(num_chunks, [&](std::size_t chunk)
+        {
+            Histogram &histogram = chunk_histograms[chunk];
+            histogram.fill(0);
+            for (int value : chunk_of(from, chunk))
+            {
+                histogram[radix_digit(value, min, pass)]++;
+            }
+        });
+        Histogram total{};
+        for (const Histogram &histogram : chunk_histograms)
+        {
+            for (int bucket = 0; bucket < kNumBuckets; bucket++)
+            {
+                total[bucket] += histogram[bucket];
+            }
+        }
+        if (pass_is_trivial(total, values.size()))
+        {
+            continue;
+        }
+        // Each chunk's values for a bucket go after the earlier chunks' values for the same bucket
+        std::size_t offset = 0;
+        for (int bucket = 0; bucket < kNumBuckets; bucket++)
+        {
+            for (Histogram &histogram : chunk_histograms)
+            {
+                std::size_t count = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += count;
+            }
+        }
+        pool.parallel_for(num_chunks, [&](std::size_t chunk)
+        {
+            Histogram &offsets = chunk_histograms[chunk];
+            for (int value : chunk_of(from, chunk))
+            {
+                to[offsets[radix_digit(value, min, pass)]++] = value;
+            }
+        });
+        std::swap(from, to);
+    }
+    if (from.data() != values.data())
+    {
+        std::copy(from.begin(), from.end(), values.begin());
+    }
+}
+
+void sort_integers_impl(std::span<int> values, ThreadPool *pool, std::pmr::memory_resource *scratch_resource)
+{
+    if (values.size() < kSmallSortSize)
+    {
+        std::sort(values.begin(), values.end());
+        return;
+    }
+    auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+    int min = *min_it;
+    uint32_t range = radix_key(*max_it, min);
+    if (range <= values.size() && range < kMaxCountingRange)
+    {
+        counting_sort(values, min, range, scratch_resource);
+        return;
+    }
+    int num_passes = (std::bit_width(range) + kRadixBits - 1) / kRadixBits;
+    if (pool != nullptr && pool->num_threads() > 1 && values.size() >= kMinParallelSize)
+    {
+        parallel_radix_sort(values, min, num_passes, *pool, scratch_resource);
+    }
+    else
+    {
+        radix_sort(values, min, num_passes, scratch_resource);
+    }
+}
+
+} // namespace
+
+void sort_integers(std::span<int> values, std::pmr::memory_resource *scratch_resource)
+{
+    sort_integers_impl(values, nullptr, scratch_resource);
+}
+
+void sort_integers(std::span<int> values, ThreadPool &pool, std::pmr::memory_resource *scratch_resource)
+{
+    sort_integers_impl(values, &pool, scratch_resource);
+}
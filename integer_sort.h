@@ -0,0 +1,21 @@
+#ifndef INTEGER_SORT_H_
+#define INTEGER_SORT_H_
+
+#include <memory_resource>
+#include <span>
+
+#include "thread_pool.h"
+
+// Sorts |values| in ascending order in linear time, as a drop in replacement for std::sort on ints.
+// If the values span a range no wider than there are values (e.g. day 1's entries are all in [0, 2020]) it's a
+// counting sort. Otherwise it's an LSD radix sort a byte at a time on the values' offset from the minimum, which
+// handles negative values and skips the bytes every value has in common, so a narrow range takes fewer passes.
+// Small inputs just go to std::sort.
+// The scratch space for the counts or radix passes comes from |scratch_resource|, e.g. the runner's per-job arena.
+void sort_integers(std::span<int> values, std::pmr::memory_resource *scratch_resource = std::pmr::get_default_resource());
+
+// Same as above, but the histograms and scatters of every radix pass are split over |pool|.
+void sort_integers(std::span<int> values, ThreadPool &pool,
+                   std::pmr::memory_resource *scratch_resource = std::pmr::get_default_resource());
+
+#endif // INTEGER_SORT_H_
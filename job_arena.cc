@@ -0,0 +1,33 @@
+#include "job_arena.h"
+
+namespace
+{
+
+// Enough for the chunk lists and per-chunk results of a small job without ever going to the heap
+constexpr std::size_t kInitialSize = 64 * 1024;
+
+} // namespace
+
+JobArena::JobArena() : buffer_(std::make_unique_for_overwrite<std::byte[]>(kInitialSize)), buffer_size_(kInitialSize)
+{
+    arena_.emplace(buffer_.get(), buffer_size_);
+}
+
+void JobArena::reset()
+{
+    arena_.reset();
+    if (used_ > buffer_size_)
+    {
+        // A quarter more than the job needed so a slightly bigger one next time still fits
+        buffer_size_ = used_ + used_ / 4;
+        buffer_ = std::make_unique_for_overwrite<std::byte[]>(buffer_size_);
+    }
+    used_ = 0;
+    arena_.emplace(buffer_.get(), buffer_size_);
+}
+
+void *JobArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    used_ += bytes + alignment;
+    return arena_->allocate(bytes, alignment);
+}
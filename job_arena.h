@@ -0,0 +1,43 @@
+#ifndef JOB_ARENA_H_
+#define JOB_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// JobArena is a monotonic arena for everything one job parses into: allocating is a pointer bump, nothing is freed
+// until the job is done, and parsing never contends with other threads on the global allocator. Unlike a plain
+// std::pmr::monotonic_buffer_resource it keeps its memory between jobs: reset() grows its buffer to whatever the
+// last job used, so once the largest job has run, later jobs don't touch the heap at all.
+// Like the monotonic resource it isn't thread safe, so only the thread running the job may allocate from it (tasks
+// on a pool write into memory the job's thread allocated up front).
+class JobArena : public std::pmr::memory_resource
+{
+public:
+    JobArena();
+
+    JobArena(const JobArena &) = delete;
+    JobArena &operator=(const JobArena &) = delete;
+
+    // Frees everything allocated since the last reset. Memory allocated from the arena must not be used after this.
+    void reset();
+
+    // Bytes of the buffer that's reused between jobs
+    std::size_t capacity() const { return buffer_size_; }
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    // Monotonic, memory is only given back by reset()
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    std::unique_ptr<std::byte[]> buffer_;
+    std::size_t buffer_size_ = 0;
+    // Everything requested since the last reset, padding included, i.e. how big the buffer needs to be
+    std::size_t used_ = 0;
+    // Allocates from |buffer_| and from the heap once that runs out
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+};
+
+#endif // JOB_ARENA_H_
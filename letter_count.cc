@@ -0,0 +1,199 @@
+#include "letter_count.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#include "cpu_dispatch.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define LETTER_COUNT_X86 1
+#endif
+
+namespace
+{
+
+int count_letter_scalar(std::string_view text, char letter)
+{
+    int letter_count = 0;
+    for (char c : text)
+    {
+        letter_count += c == letter;
+    }
+    return letter_count;
+}
+
+void count_letters_packed_scalar(std::span<const std::string_view> texts, std::span<const char> letters,
+                                 std::span<int> counts)
+{
+    for (std::size_t i = 0; i < texts.size(); i++)
+    {
+        counts[i] = count_letter_scalar(texts[i], letters[i]);
+    }
+}
+
+#if defined(LETTER_COUNT_X86)
+
+// Copies |size| (at most 32) bytes with two overlapping fixed size copies, which compile to a pair of loads and
+// stores instead of a call to memcpy. Never reads outside of [src, src + size).
+__attribute__((always_inline)) inline void copy_short(char *dst, const char *src, std::size_t size)
+{
+    if (size >= 16)
+    {
+        std::memcpy(dst, src, 16);
+        std::memcpy(dst + size - 16, src + size - 16, 16);
+    }
+    else if (size >= 8)
+    {
+        std::memcpy(dst, src, 8);
+        std::memcpy(dst + size - 8, src + size - 8, 8);
+    }
+    else if (size >= 4)
+    {
+        std::memcpy(dst, src, 4);
+        std::memcpy(dst + size - 4, src + size - 4, 4);
+    }
+    else if (size > 0)
+    {
+        dst[0] = src[0];
+        dst[size / 2] = src[size / 2];
+        dst[size - 1] = src[size - 1];
+    }
+}
+
+// The packed kernels copy as many whole texts as fit into one register, with a second register that repeats
+// each text's letter over the same bytes. A single compare then gives a bit per byte, and each text's count is
+// the popcount of its slice of the mask.
+// |compare_mask| compares |kWidth| bytes of the two buffers and returns the movemask. Both kernels are template
+// arguments and the driver is always inlined into its caller, so each ISA's driver (compiled for that target) calls
+// them directly and the compare inlines into the packing loop.
+template <int kWidth, auto count_letter_fn, auto compare_mask>
+__attribute__((always_inline)) inline void count_letters_packed_impl(std::span<const std::string_view> texts,
+                                                                     std::span<const char> letters, std::span<int> counts)
+{
+    alignas(kWidth) char text_buf[kWidth];
+    // Each text's letter is written over a whole register's worth of bytes, a fixed size memset that compiles to a
+    // couple of stores, and the next text's letter overwrites the excess. Hence twice the width.
+    alignas(kWidth) char letter_buf[2 * kWidth];
+    int offsets[kWidth];
+    std::size_t i = 0;
+    while (i < texts.size())
+    {
+        if (texts[i].size() > kWidth)
+        {
+            // Doesn't fit in a register on its own, the per-string kernel is the better choice anyway
+            counts[i] = count_letter_fn(texts[i], letters[i]);
+            i++;
+            continue;
+        }
+        std::size_t start = i;
+        int used = 0;
+        // Empty texts don't take up any bytes, so |offsets| has to be bounded by the text count as well
+        while (i < texts.size() && i - start < kWidth && used + texts[i].size() <= kWidth)
+        {
+            copy_short(text_buf + used, texts[i].data(), texts[i].size());
+            std::memset(letter_buf + used, letters[i], kWidth);
+            offsets[i - start] = used;
+            used += texts[i].size();
+            i++;
+        }
+        // Whatever is left over in the buffers is never looked at since each text only reads its own slice
+        uint64_t mask = static_cast<uint32_t>(compare_mask(text_buf, letter_buf));
+        for (std::size_t j = start; j < i; j++)
+        {
+            uint64_t text_bits = (uint64_t{1} << texts[j].size()) - 1;
+            counts[j] = std::popcount((mask >> offsets[j - start]) & text_bits);
+        }
+    }
+}
+
+int count_letter_sse2(std::string_view text, char letter)
+{
+    const __m128i letters = _mm_set1_epi8(letter);
+    int letter_count = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= text.size(); i += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i));
+        letter_count += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, letters))));
+    }
+    return letter_count + count_letter_scalar(text.substr(i), letter);
+}
+
+inline int compare_mask_sse2(const char *text, const char *letter)
+{
+    __m128i text_chunk = _mm_load_si128(reinterpret_cast<const __m128i *>(text));
+    __m128i letter_chunk = _mm_load_si128(reinterpret_cast<const __m128i *>(letter));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(text_chunk, letter_chunk));
+}
+
+void count_letters_packed_sse2(std::span<const std::string_view> texts, std::span<const char> letters,
+                               std::span<int> counts)
+{
+    count_letters_packed_impl<16, count_letter_sse2, compare_mask_sse2>(texts, letters, counts);
+}
+
+__attribute__((target("avx2"))) int count_letter_avx2(std::string_view text, char letter)
+{
+    const __m256i letters = _mm256_set1_epi8(letter);
+    int letter_count = 0;
+    std::size_t i = 0;
+    for (; i + 32 <= text.size(); i += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text.data() + i));
+        letter_count += std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, letters))));
+    }
+    // Less than 32 bytes left, the SSE2 kernel can still take a 16 byte chunk of it
+    return letter_count + count_letter_sse2(text.substr(i), letter);
+}
+
+__attribute__((target("avx2"))) inline int compare_mask_avx2(const char *text, const char *letter)
+{
+    __m256i text_chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(text));
+    __m256i letter_chunk = _mm256_load_si256(reinterpret_cast<const __m256i *>(letter));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(text_chunk, letter_chunk));
+}
+
+// Compiled for AVX2 as a whole, so the driver inlined here can inline compare_mask_avx2 too
+__attribute__((target("avx2"))) void count_letters_packed_avx2(std::span<const std::string_view> texts,
+                                                               std::span<const char> letters, std::span<int> counts)
+{
+    count_letters_packed_impl<32, count_letter_avx2, compare_mask_avx2>(texts, letters, counts);
+}
+
+#endif // LETTER_COUNT_X86
+
+using CountLetterFn = int (*)(std::string_view, char);
+using CountLettersPackedFn = void (*)(std::span<const std::string_view>, std::span<const char>, std::span<int>);
+
+struct Kernels
+{
+    CountLetterFn count_letter;
+    CountLettersPackedFn count_letters_packed;
+};
+
+constexpr Kernels kScalarKernels = {count_letter_scalar, count_letters_packed_scalar};
+#if defined(LETTER_COUNT_X86)
+constexpr Kernels kSse2Kernels = {count_letter_sse2, count_letters_packed_sse2};
+constexpr Kernels kAvx2Kernels = {count_letter_avx2, count_letters_packed_avx2};
+#endif
+
+const Kernels &kernels()
+{
+#if defined(LETTER_COUNT_X86)
+    return *pick_simd_kernel(&kScalarKernels, &kSse2Kernels, &kAvx2Kernels);
+#else
+    return kScalarKernels;
+#endif
+}
+
+} // namespace
+
+int count_letter(std::string_view text, char letter) { return kernels().count_letter(text, letter); }
+
+void count_letters_packed(std::span<const std::string_view> texts, std::span<const char> letters, std::span<int> counts)
+{
+    kernels().count_letters_packed(texts, letters, counts);
+}
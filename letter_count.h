@@ -0,0 +1,19 @@
+#ifndef LETTER_COUNT_H_
+#define LETTER_COUNT_H_
+
+#include <span>
+#include <string_view>
+
+// Vectorized letter counting for the day 2 password policies. Both functions pick the widest kernel the CPU
+// supports at runtime (AVX2, then SSE2, then a plain loop) so the binary doesn't need to be built with -mavx2.
+
+// Returns how many times |letter| appears in |text|.
+int count_letter(std::string_view text, char letter);
+
+// Same as calling count_letter(texts[i], letters[i]) for every i and storing the result in counts[i], but meant
+// for lots of short strings: several of them are packed into one vector register and compared in one go, which
+// a per-string kernel can't do since most passwords are shorter than a single register.
+// All three spans must be the same size.
+void count_letters_packed(std::span<const std::string_view> texts, std::span<const char> letters, std::span<int> counts);
+
+#endif // LETTER_COUNT_H_
@@ -0,0 +1,415 @@
+#include "parsed_input_cache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "day_1_report_repair.h"
+#include "integer_sort.h"
+
+namespace
+{
+
+constexpr char kMagic[8] = {'A', 'O', 'C', 'P', 'A', 'R', 'S', 'E'};
+// Bump whenever a payload layout changes so old caches are rebuilt instead of misread
+constexpr uint32_t kVersion = 1;
+constexpr int kSeatCodesPerWord = 64 / kPassChars;
+
+static_assert(sizeof(int) == sizeof(int32_t), "day 1 entries are cached as int32 and handed back as int");
+static_assert(sizeof(PasswordRecord) == 12);
+
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t day;
+    uint64_t content_hash;
+    uint64_t content_size;
+    uint64_t num_records;
+    // Only used by day 6
+    uint64_t num_groups;
+    uint64_t payload_size;
+};
+
+// The payload starts right after the header, which keeps the uint64 seat codes aligned
+static_assert(sizeof(CacheHeader) % alignof(uint64_t) == 0);
+
+struct Payload
+{
+    std::string bytes;
+    uint64_t num_records = 0;
+    uint64_t num_groups = 0;
+};
+
+template <typename T>
+void append_array(std::string &bytes, const T *values, std::size_t count)
+{
+    bytes.append(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+Payload build_day_1_payload(std::string_view contents)
+{
+    std::vector<int> entries = parse_entries(contents);
+    sort_integers(entries);
+    Payload payload;
+    payload.num_records = entries.size();
+    append_array(payload.bytes, entries.data(), entries.size());
+    return payload;
+}
+
+absl::StatusOr<Payload> build_day_2_payload(std::string_view contents)
+{
+    std::vector<PasswordRecord> records;
+    std::vector<uint32_t> offsets = {0};
+    std::string passwords;
+    for_each_line(contents, [&](std::string_view line)
+    {
+        std::string_view policy;
+        std::string_view pw;
+        split_policy_and_password(line, policy, pw);
+        PolicyFields fields = parse_policy_fields(policy);
+        // Same as scan_valid_passwords, lines that don't parse aren't counted
+        if (fields.letter == '\0')
+        {
+            return;
+        }
+        records.push_back(PasswordRecord{fields.first, fields.second, fields.letter, {}});
+        passwords.append(pw);
+        offsets.push_back(passwords.size());
+    });
+    if (passwords.size() > UINT32_MAX)
+    {
+        return absl::OutOfRangeError("day 2 passwords don't fit in 32-bit cache offsets");
+    }
+    Payload payload;
+    payload.num_records = records.size();
+    append_array(payload.bytes, records.data(), records.size());
+    append_array(payload.bytes, offsets.data(), offsets.size());
+    payload.bytes.append(passwords);
+    return payload;
+}
+
+Payload build_day_5_payload(std::string_view contents)
+{
+    std::pmr::vector<int> seat_ids;
+    decode_seat_ids(contents, seat_ids);
+    std::vector<uint64_t> words((seat_ids.size() + kSeatCodesPerWord - 1) / kSeatCodesPerWord);
+    for (std::size_t i = 0; i < seat_ids.size(); i++)
+    {
+        words[i / kSeatCodesPerWord] |= uint64_t(seat_ids[i]) << (i % kSeatCodesPerWord * kPassChars);
+    }
+    Payload payload;
+    payload.num_records = seat_ids.size();
+    append_array(payload.bytes, words.data(), words.size());
+    return payload;
+}
+
+Payload build_day_6_payload(std::string_view contents)
+{
+    std::vector<uint32_t> masks;
+    std::vector<uint32_t> group_offsets = {0};
+    for_each_line(contents, [&](std::string_view line)
+    {
+        if (!line.empty())
+        {
+            masks.push_back(answer_mask(line));
+        }
+        // Consecutive blank lines don't make empty groups, same as GroupAnswerAggregator
+        else if (masks.size() != group_offsets.back())
+        {
+            group_offsets.push_back(masks.size());
+        }
+    });
+    if (masks.size() != group_offsets.back())
+    {
+        group_offsets.push_back(masks.size());
+    }
+    Payload payload;
+    payload.num_records = masks.size();
+    payload.num_groups = group_offsets.size() - 1;
+    append_array(payload.bytes, masks.data(), masks.size());
+    append_array(payload.bytes, group_offsets.data(), group_offsets.size());
+    return payload;
+}
+
+absl::StatusOr<Payload> build_payload(int day, std::string_view contents)
+{
+    switch (day)
+    {
+    case 1:
+        return build_day_1_payload(contents);
+    case 2:
+        return build_day_2_payload(contents);
+    case 5:
+        return build_day_5_payload(contents);
+    case 6:
+        return build_day_6_payload(contents);
+    default:
+        return absl::InvalidArgumentError(absl::StrFormat("no cached form for day %d", day));
+    }
+}
+
+// The smallest payload that holds |header|'s records, so a truncated file is caught before anything reads past
+// the end of the mapping. Day 2's password bytes are checked separately since their size is in the offsets.
+// The counts come from the file, so each one is checked against the payload size before it's multiplied. A count
+// that can't fit gives UINT64_MAX rather than a product that wrapped around to something small.
+uint64_t min_payload_size(const CacheHeader &header)
+{
+    auto too_many = [&header](uint64_t count, uint64_t item_size) { return count > header.payload_size / item_size; };
+    switch (header.day)
+    {
+    case 1:
+        if (too_many(header.num_records, sizeof(int32_t)))
+        {
+            return UINT64_MAX;
+        }
+        return header.num_records * sizeof(int32_t);
+    case 2:
+        // Each record also has an offset, plus one more offset for the end of the last password
+        if (too_many(header.num_records, sizeof(PasswordRecord) + sizeof(uint32_t)))
+        {
+            return UINT64_MAX;
+        }
+        return header.num_records * sizeof(PasswordRecord) + (header.num_records + 1) * sizeof(uint32_t);
+    case 5:
+    {
+        uint64_t num_words = header.num_records / kSeatCodesPerWord + (header.num_records % kSeatCodesPerWord != 0);
+        if (too_many(num_words, sizeof(uint64_t)))
+        {
+            return UINT64_MAX;
+        }
+        return num_words * sizeof(uint64_t);
+    }
+    case 6:
+        if (too_many(header.num_records, sizeof(uint32_t)) || too_many(header.num_groups, sizeof(uint32_t)))
+        {
+            return UINT64_MAX;
+        }
+        return header.num_records * sizeof(uint32_t) + (header.num_groups + 1) * sizeof(uint32_t);
+    default:
+        return UINT64_MAX;
+    }
+}
+
+CacheHeader read_header(std::string_view contents)
+{
+    CacheHeader header;
+    std::memcpy(&header, contents.data(), sizeof(header));
+    return header;
+}
+
+inline uint64_t mix(uint64_t hash, uint64_t word)
+{
+    constexpr uint64_t kMul1 = 0x87c37b91114253d5;
+    constexpr uint64_t kMul2 = 0x4cf5ad432745937f;
+    return std::rotl(hash ^ (word * kMul1), 31) * kMul2;
+}
+
+} // namespace
+
+uint64_t content_hash(std::string_view contents)
+{
+    // Four independent lanes so the multiplies overlap instead of waiting on each other
+    std::array<uint64_t, 4> lanes = {0x9e3779b97f4a7c15, 0xbf58476d1ce4e5b9, 0x94d049bb133111eb, contents.size()};
+    const char *data = contents.data();
+    std::size_t pos = 0;
+    for (; pos + sizeof(lanes) <= contents.size(); pos += sizeof(lanes))
+    {
+        for (int lane = 0; lane < 4; lane++)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + pos + lane * sizeof(uint64_t), sizeof(word));
+            lanes[lane] = mix(lanes[lane], word);
+        }
+    }
+    uint64_t hash = lanes[0] ^ std::rotl(lanes[1], 16) ^ std::rotl(lanes[2], 32) ^ std::rotl(lanes[3], 48);
+    for (; pos < contents.size(); pos += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, data + pos, std::min(sizeof(word), contents.size() - pos));
+        hash = mix(hash, word);
+    }
+    // murmur3's finalizer so every input bit affects every output bit
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+std::string cache_path(std::string_view cache_dir, int day, uint64_t hash)
+{
+    return absl::StrFormat("%s/day_%d_%016x.aoccache", cache_dir, day, hash);
+}
+
+absl::StatusOr<CachedInput> CachedInput::open(std::string_view path, int day, uint64_t hash, uint64_t contents_size)
+{
+    auto file = MappedFile::open(path);
+    if (!file.ok())
+    {
+        return file.status();
+    }
+    std::string_view contents = file->contents();
+    if (contents.size() < sizeof(CacheHeader))
+    {
+        return absl::DataLossError(absl::StrFormat("%s is too small to be a cache", path));
+    }
+    CacheHeader header = read_header(contents);
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.day != static_cast<uint32_t>(day) || header.content_hash != hash ||
+        header.content_size != contents_size)
+    {
+        return absl::DataLossError(absl::StrFormat("%s is not the cache of this day %d input", path, day));
+    }
+    if (header.payload_size != contents.size() - sizeof(CacheHeader) || header.payload_size < min_payload_size(header))
+    {
+        return absl::DataLossError(absl::StrFormat("%s is truncated", path));
+    }
+    CachedInput cached(*std::move(file));
+    if (day == 2)
+    {
+        // count_valid_passwords() slices the passwords with these offsets without checking them, so a corrupted table
+        // has to be rejected here rather than read outside the mapping
+        uint64_t passwords_size = header.payload_size - min_payload_size(header);
+        std::span<const uint32_t> offsets =
+            cached.section<uint32_t>(header.num_records * sizeof(PasswordRecord), header.num_records + 1);
+        if (!std::is_sorted(offsets.begin(), offsets.end()) || offsets.back() > passwords_size)
+        {
+            return absl::DataLossError(absl::StrFormat("%s has a corrupted password offset table", path));
+        }
+    }
+    return cached;
+}
+
+int CachedInput::day() const { return read_header(file_.contents()).day; }
+
+int64_t CachedInput::num_records() const { return read_header(file_.contents()).num_records; }
+
+template <typename T>
+std::span<const T> CachedInput::section(std::size_t offset, std::size_t count) const
+{
+    return std::span<const T>(reinterpret_cast<const T *>(file_.contents().data() + sizeof(CacheHeader) + offset),
+                              count);
+}
+
+std::span<const int> CachedInput::sorted_entries() const { return section<int>(0, num_records()); }
+
+ValidPasswordCounts CachedInput::count_valid_passwords() const
+{
+    std::size_t num_entries = num_records();
+    std::span<const PasswordRecord> records = section<PasswordRecord>(0, num_entries);
+    std::size_t offsets_start = num_entries * sizeof(PasswordRecord);
+    std::span<const uint32_t> offsets = section<uint32_t>(offsets_start, num_entries + 1);
+    const char *passwords = section<char>(offsets_start + offsets.size_bytes(), 0).data();
+    ValidPasswordCounts counts;
+    counts.num_entries = num_entries;
+    for (std::size_t i = 0; i < num_entries; i++)
+    {
+        const PasswordRecord &record = records[i];
+        std::string_view pw(passwords + offsets[i], offsets[i + 1] - offsets[i]);
+        counts.old_policy += OldPasswordPolicy::check(record.first, record.second, record.letter, pw);
+        counts.new_policy += NewPasswordPolicy::check(record.first, record.second, record.letter, pw);
+    }
+    return counts;
+}
+
+int64_t CachedInput::mark_seats(SeatMap &seat_map) const
+{
+    int64_t num_passes = num_records();
+    std::span<const uint64_t> words = section<uint64_t>(0, (num_passes + kSeatCodesPerWord - 1) / kSeatCodesPerWord);
+    for (int64_t i = 0; i < num_passes; i++)
+    {
+        seat_map.mark_occupied((words[i / kSeatCodesPerWord] >> (i % kSeatCodesPerWord * kPassChars)) & kMaxSeatId);
+    }
+    return num_passes;
+}
+
+GroupAnswerCounts CachedInput::sum_group_answers() const
+{
+    std::size_t num_people = num_records();
+    std::span<const uint32_t> masks = section<uint32_t>(0, num_people);
+    std::span<const uint32_t> group_offsets =
+        section<uint32_t>(masks.size_bytes(), read_header(file_.contents()).num_groups + 1);
+    GroupAnswerAggregator aggregator;
+    for (std::size_t group = 0; group + 1 < group_offsets.size(); group++)
+    {
+        for (uint32_t person = group_offsets[group]; person < group_offsets[group + 1] && person < num_people; person++)
+        {
+            aggregator.add_person(masks[person]);
+        }
+        aggregator.end_group();
+    }
+    return aggregator.finish();
+}
+
+absl::Status write_cached_input(std::string_view path, int day, std::string_view contents, uint64_t hash)
+{
+    auto payload = build_payload(day, contents);
+    if (!payload.ok())
+    {
+        return payload.status();
+    }
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.day = day;
+    header.content_hash = hash;
+    header.content_size = contents.size();
+    header.num_records = payload->num_records;
+    header.num_groups = payload->num_groups;
+    header.payload_size = payload->bytes.size();
+
+    std::string temp_path = absl::StrFormat("%s.tmp.%d", path, ::getpid());
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(payload->bytes.data(), payload->bytes.size());
+        if (!out)
+        {
+            std::filesystem::remove(temp_path);
+            return absl::InternalError(absl::StrFormat("unable to write %s", temp_path));
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, std::string(path), error);
+    if (error)
+    {
+        std::filesystem::remove(temp_path);
+        return absl::InternalError(absl::StrFormat("unable to rename %s to %s: %s", temp_path, path, error.message()));
+    }
+    return absl::OkStatus();
+}
+
+absl::StatusOr<CachedInput> load_or_build_cached_input(std::string_view cache_dir, int day, std::string_view contents)
+{
+    uint64_t hash = content_hash(contents);
+    std::string path = cache_path(cache_dir, day, hash);
+    auto cached = CachedInput::open(path, day, hash, contents.size());
+    if (cached.ok() || (!absl::IsNotFound(cached.status()) && !absl::IsDataLoss(cached.status())))
+    {
+        return cached;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(std::string(cache_dir), error);
+    if (error)
+    {
+        return absl::InternalError(absl::StrFormat("unable to create %s: %s", cache_dir, error.message()));
+    }
+    absl::Status status = write_cached_input(path, day, contents, hash);
+    if (!status.ok())
+    {
+        return status;
+    }
+    return CachedInput::open(path, day, hash, contents.size());
+}
@@ -0,0 +1,83 @@
+#ifndef PARSED_INPUT_CACHE_H_
+#define PARSED_INPUT_CACHE_H_
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "day_2_password_philosophy.h"
+#include "day_5_binary_boarding.h"
+#include "day_6_custom_customs.h"
+#include "input_reader.h"
+
+// The parsed input cache stores each input in a compact binary form so runs that see the same input again (e.g.
+// regression and replay jobs) can map it and go straight to solving instead of parsing text. Cache files are
+// named after the day and a hash of the input's contents, so an edited input never picks up a stale parse.
+//
+// After a fixed header, each day's payload is
+//   day 1: the entries as int32, already sorted
+//   day 2: a fixed width PasswordRecord per line, then num_records + 1 uint32 offsets into the password bytes that
+//          follow them (password i is bytes [offsets[i], offsets[i + 1]))
+//   day 5: the 10-bit seat codes, packed six to a uint64
+//   day 6: one 26-bit answer mask per person as uint32, then num_groups + 1 uint32 offsets into the masks where
+//          each group starts
+// Everything is stored in the machine's native byte order, the cache isn't meant to be shared between machines.
+
+// A non-cryptographic 64-bit hash of |contents|, read 8 bytes at a time so hashing costs far less than parsing.
+uint64_t content_hash(std::string_view contents);
+
+// The cache file for an input of |day| whose contents hash to |hash|.
+std::string cache_path(std::string_view cache_dir, int day, uint64_t hash);
+
+struct PasswordRecord
+{
+    int32_t first;
+    int32_t second;
+    char letter;
+    char padding[3];
+};
+
+// A cache file mapped into memory. The views it hands out point into the mapping.
+class CachedInput
+{
+public:
+    // Maps |path| and checks that it is the cache of |day| for |contents_size| bytes of input hashing to |hash|.
+    // Returns NotFound if there is no cache file and DataLoss if it doesn't match or is truncated.
+    static absl::StatusOr<CachedInput> open(std::string_view path, int day, uint64_t hash, uint64_t contents_size);
+
+    int day() const;
+    // Entries for day 1, lines for day 2, passes for day 5 and people for day 6
+    int64_t num_records() const;
+
+    // Day 1's entries in ascending order
+    std::span<const int> sorted_entries() const;
+
+    // Day 2 counts straight from the records
+    ValidPasswordCounts count_valid_passwords() const;
+
+    // Marks day 5's seats in |seat_map| and returns the number of passes
+    int64_t mark_seats(SeatMap &seat_map) const;
+
+    // Day 6 sums straight from the masks
+    GroupAnswerCounts sum_group_answers() const;
+
+private:
+    explicit CachedInput(MappedFile file) : file_(std::move(file)) {}
+
+    template <typename T>
+    std::span<const T> section(std::size_t offset, std::size_t count) const;
+
+    MappedFile file_;
+};
+
+// Parses |contents| as |day|'s input and writes its cache to |path|. The cache is written to a temporary file
+// first and renamed into place, so a concurrent run never maps a partial cache.
+absl::Status write_cached_input(std::string_view path, int day, std::string_view contents, uint64_t hash);
+
+// Maps the cache for |contents| from |cache_dir|, parsing and writing it first if there isn't one yet.
+absl::StatusOr<CachedInput> load_or_build_cached_input(std::string_view cache_dir, int day, std::string_view contents);
+
+#endif // PARSED_INPUT_CACHE_H_
@@ -0,0 +1,253 @@
+#include "solver_registry.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "day_1_report_repair.h"
+#include "day_2_password_philosophy.h"
+#include "day_5_binary_boarding.h"
+#include "day_6_custom_customs.h"
+#include "integer_sort.h"
+
+namespace
+{
+
+absl::StatusOr<int64_t> k_sum_product(std::span<const int> sorted_entries, int k, ThreadPool &pool)
+{
+    auto indices = find_k_sum(sorted_entries, k, kEntrySumTarget, pool);
+    if (!indices.ok())
+    {
+        return indices.status();
+    }
+    int64_t product = 1;
+    for (size_t index : *indices)
+    {
+        product *= sorted_entries[index];
+    }
+    return product;
+}
+
+absl::StatusOr<std::string> solve_sorted_day_1(std::span<const int> sorted_entries, SolveContext &context)
+{
+    ScopedPhase phase(context.profiler, "solve");
+    auto pair_product = k_sum_product(sorted_entries, 2, context.pool);
+    if (!pair_product.ok())
+    {
+        return pair_product.status();
+    }
+    auto triplet_product = k_sum_product(sorted_entries, 3, context.pool);
+    if (!triplet_product.ok())
+    {
+        return triplet_product.status();
+    }
+    return absl::StrFormat("pair product: %d triplet product: %d", *pair_product, *triplet_product);
+}
+
+absl::StatusOr<std::string> solve_day_1(std::string_view contents, SolveContext &context)
+{
+    std::pmr::vector<int> entries(&context.arena);
+    {
+        ScopedPhase phase(context.profiler, "parse");
+        if (context.pool.num_threads() == 1)
+        {
+            parse_entries(contents, entries);
+            sort_integers(entries, &context.arena);
+        }
+        else
+        {
+            parse_sorted_entries(contents, context.pool, entries);
+        }
+    }
+    return solve_sorted_day_1(entries, context);
+}
+
+absl::StatusOr<std::string> cached_day_1(const CachedInput &cached, SolveContext &context)
+{
+    return solve_sorted_day_1(cached.sorted_entries(), context);
+}
+
+std::string format_password_counts(const ValidPasswordCounts &counts)
+{
+    return absl::StrFormat("valid passwords (old): %d valid passwords (new): %d", counts.old_policy,
+                           counts.new_policy);
+}
+
+absl::StatusOr<std::string> solve_day_2(std::string_view contents, SolveContext &context)
+{
+    // The lines are checked as they are parsed, so the phases can't be told apart
+    ScopedPhase phase(context.profiler, "parse and solve");
+    // The scan stores nothing per line, only the parallel path's chunk bookkeeping needs the arena
+    ValidPasswordCounts counts = context.pool.num_threads() == 1
+                                     ? scan_valid_passwords(contents)
+                                     : count_valid_passwords_parallel(contents, context.pool, &context.arena);
+    return format_password_counts(counts);
+}
+
+absl::StatusOr<std::string> stream_day_2(int fd, SolveContext &context)
+{
+    ScopedPhase phase(context.profiler, "read, parse and solve");
+    auto counts = count_valid_passwords_streaming(fd);
+    if (!counts.ok())
+    {
+        return counts.status();
+    }
+    return format_password_counts(*counts);
+}
+
+absl::StatusOr<std::string> cached_day_2(const CachedInput &cached, SolveContext &context)
+{
+    ScopedPhase phase(context.profiler, "solve");
+    return format_password_counts(cached.count_valid_passwords());
+}
+
+std::string format_seat_map(const SeatMap &seat_map)
+{
+    return absl::StrFormat("max seat ID: %d my seat: %d", seat_map.max_occupied_seat(), seat_map.find_my_seat());
+}
+
+absl::StatusOr<std::string> solve_day_5(std::string_view contents, SolveContext &context)
+{
+    SeatMap seat_map;
+    if (context.pool.num_threads() == 1)
+    {
+        std::pmr::vector<int> seat_ids(&context.arena);
+        {
+            ScopedPhase phase(context.profiler, "parse");
+            decode_seat_ids(contents, seat_ids);
+        }
+        ScopedPhase phase(context.profiler, "solve");
+        for (int seat_id : seat_ids)
+        {
+            seat_map.mark_occupied(seat_id);
+        }
+        return format_seat_map(seat_map);
+    }
+    // Each chunk is decoded and marked by the same task, so the phases can't be told apart
+    ScopedPhase phase(context.profiler, "parse and solve");
+    build_seat_map(contents, context.pool, seat_map, &context.arena);
+    return format_seat_map(seat_map);
+}
+
+absl::StatusOr<std::string> cached_day_5(const CachedInput &cached, SolveContext &context)
+{
+    ScopedPhase phase(context.profiler, "solve");
+    SeatMap seat_map;
+    cached.mark_seats(seat_map);
+    return format_seat_map(seat_map);
+}
+
+absl::StatusOr<std::string> stream_day_5(int fd, SolveContext &context)
+{
+    ScopedPhase phase(context.profiler, "read, parse and solve");
+    SeatMap seat_map;
+    auto num_passes = build_seat_map_streaming(fd, seat_map);
+    if (!num_passes.ok())
+    {
+        return num_passes.status();
+    }
+    return format_seat_map(seat_map);
+}
+
+std::string format_group_counts(const GroupAnswerCounts &counts)
+{
+    return absl::StrFormat("anyone: %d everyone: %d", counts.anyone, counts.everyone);
+}
+
+absl::StatusOr<std::string> solve_day_6(std::string_view contents, SolveContext &context)
+{
+    // Groups are summed as they are parsed, there is no separate parse phase
+    ScopedPhase phase(context.profiler, "parse and solve");
+    GroupAnswerCounts counts = context.pool.num_threads() == 1
+                                   ? sum_group_answers(contents)
+                                   : sum_group_answers_parallel(contents, context.pool, &context.arena);
+    return format_group_counts(counts);
+}
+
+absl::StatusOr<std::string> stream_day_6(int fd, SolveContext &context)
+{
+    ScopedPhase phase(context.profiler, "read, parse and solve");
+    auto counts = sum_group_answers_streaming(fd);
+    if (!counts.ok())
+    {
+        return counts.status();
+    }
+    return format_group_counts(*counts);
+}
+
+absl::StatusOr<std::string> cached_day_6(const CachedInput &cached, SolveContext &context)
+{
+    ScopedPhase phase(context.profiler, "solve");
+    return format_group_counts(cached.sum_group_answers());
+}
+
+struct RegisteredDay
+{
+    int day;
+    Solver solver;
+    // nullptr if the day can't be solved from a stream
+    StreamSolver stream_solver;
+    CachedSolver cached_solver;
+};
+
+constexpr std::array<RegisteredDay, 4> kSolvers = {{
+    {1, solve_day_1, nullptr, cached_day_1},
+    {2, solve_day_2, stream_day_2, cached_day_2},
+    {5, solve_day_5, stream_day_5, cached_day_5},
+    {6, solve_day_6, stream_day_6, cached_day_6},
+}};
+
+} // namespace
+
+absl::StatusOr<Solver> find_solver(int day)
+{
+    for (const RegisteredDay &registered : kSolvers)
+    {
+        if (registered.day == day)
+        {
+            return registered.solver;
+        }
+    }
+    return absl::NotFoundError(absl::StrFormat("no solver registered for day %d", day));
+}
+
+absl::StatusOr<StreamSolver> find_stream_solver(int day)
+{
+    for (const RegisteredDay &registered : kSolvers)
+    {
+        if (registered.day == day)
+        {
+            if (registered.stream_solver == nullptr)
+            {
+                return absl::UnimplementedError(absl::StrFormat("day %d can't be solved from a stream", day));
+            }
+            return registered.stream_solver;
+        }
+    }
+    return absl::NotFoundError(absl::StrFormat("no solver registered for day %d", day));
+}
+
+absl::StatusOr<CachedSolver> find_cached_solver(int day)
+{
+    for (const RegisteredDay &registered : kSolvers)
+    {
+        if (registered.day == day)
+        {
+            return registered.cached_solver;
+        }
+    }
+    return absl::NotFoundError(absl::StrFormat("no solver registered for day %d", day));
+}
+
+std::vector<int> registered_days()
+{
+    std::vector<int> days;
+    for (const RegisteredDay &registered : kSolvers)
+    {
+        days.push_back(registered.day);
+    }
+    return days;
+}
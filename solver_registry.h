@@ -0,0 +1,52 @@
+#ifndef SOLVER_REGISTRY_H_
+#define SOLVER_REGISTRY_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "instrumentation.h"
+#include "job_arena.h"
+#include "parsed_input_cache.h"
+#include "thread_pool.h"
+
+// State that is shared by every job the runner solves, so running thousands of inputs in one process doesn't
+// pay for a new thread pool or fresh buffers each time.
+struct SolveContext
+{
+    explicit SolveContext(int num_threads) : pool(num_threads) {}
+
+    ThreadPool pool;
+    // Whatever a job's read path allocates (day 1 entries, day 5 seat IDs, chunk lists and per-chunk results) comes
+    // from here. The runner resets it after every job and it keeps its memory, so repeat jobs don't go to the heap
+    // or contend on its lock.
+    JobArena arena;
+    // If set, solvers record their parse and solve phases here
+    PhaseProfiler *profiler = nullptr;
+};
+
+// A solver takes a whole input file and returns both parts' answers on one line.
+using Solver = absl::StatusOr<std::string> (*)(std::string_view contents, SolveContext &context);
+
+// A stream solver reads its input from |fd| (e.g. stdin) until the end of the stream, updating the answers as the
+// records arrive, so inputs that don't fit in memory can be solved too.
+using StreamSolver = absl::StatusOr<std::string> (*)(int fd, SolveContext &context);
+
+// A cached solver skips parsing altogether and solves from the binary form in the parsed input cache.
+using CachedSolver = absl::StatusOr<std::string> (*)(const CachedInput &cached, SolveContext &context);
+
+// Returns the solver for |day|, or NotFound if that day hasn't been solved.
+absl::StatusOr<Solver> find_solver(int day);
+
+// Returns the stream solver for |day|, or NotFound if that day hasn't been solved and Unimplemented if it can't be
+// solved without holding its whole input (day 1 has to look at every pair of entries).
+absl::StatusOr<StreamSolver> find_stream_solver(int day);
+
+// Returns the cached solver for |day|, or NotFound if that day hasn't been solved.
+absl::StatusOr<CachedSolver> find_cached_solver(int day);
+
+// Every day that has a solver, in ascending order.
+std::vector<int> registered_days();
+
+#endif // SOLVER_REGISTRY_H_
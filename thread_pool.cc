@@ -0,0 +1,130 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// The pool the current thread works for and the index of its queue there. A worker of one pool can submit to
+// another, so the index only means something for |pool|.
+struct CurrentWorker
+{
+    const ThreadPool *pool = nullptr;
+    int queue_index = -1;
+};
+
+thread_local CurrentWorker current_worker;
+
+} // namespace
+
+ThreadPool::ThreadPool(int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < num_threads; i++)
+    {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    // The last queue belongs to whoever calls parallel_for, so one less thread than requested
+    for (int i = 0; i < num_threads - 1; i++)
+    {
+        threads_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    // Tasks submitted from a worker stay on that worker, anything else is spread round robin
+    int own_queue = own_queue_index();
+    std::size_t queue_index = own_queue >= 0 ? own_queue
+                                             : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex);
+        queues_[queue_index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the lock means a worker can't miss the wakeup between checking pending_tasks_ and waiting
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        pending_tasks_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::try_pop(std::size_t queue_index, bool steal, std::function<void()> &task)
+{
+    WorkerQueue &queue = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    if (steal)
+    {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+    }
+    else
+    {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+    }
+    return true;
+}
+
+bool ThreadPool::run_one_task()
+{
+    // Threads from outside the pool (i.e. the caller of parallel_for) use the last queue, which no worker owns
+    int worker_queue = own_queue_index();
+    std::size_t own_queue = worker_queue >= 0 ? worker_queue : queues_.size() - 1;
+    std::function<void()> task;
+    bool found = try_pop(own_queue, /*steal=*/false, task);
+    for (std::size_t offset = 1; !found && offset < queues_.size(); offset++)
+    {
+        found = try_pop((own_queue + offset) % queues_.size(), /*steal=*/true, task);
+    }
+    if (!found)
+    {
+        return false;
+    }
+    pending_tasks_.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+int ThreadPool::own_queue_index() const
+{
+    return current_worker.pool == this ? current_worker.queue_index : -1;
+}
+
+void ThreadPool::worker_loop(std::size_t index)
+{
+    current_worker = {this, static_cast<int>(index)};
+    while (true)
+    {
+        if (run_one_task())
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait(lock, [this] { return stop_ || pending_tasks_.load(std::memory_order_relaxed) != 0; });
+        if (stop_)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ThreadPool is a small work-stealing pool. Every worker has its own deque: it pushes and pops its own tasks
+// at the back (so recently split work stays in its cache) and, once that runs dry, steals from the front of
+// the other workers' deques. That keeps the cores busy when chunks of the input take uneven amounts of time,
+// e.g. one chunk of day 1 containing all the long lines.
+class ThreadPool
+{
+public:
+    // |num_threads| includes the calling thread, which helps out while it waits in parallel_for. A pool of 1
+    // runs everything on the caller. 0 means one thread per core.
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int num_threads() const { return queues_.size(); }
+
+    void submit(std::function<void()> task);
+
+    // Runs |fn(i)| for every i in [0, |n|) and returns once they have all finished.
+    template <typename Fn>
+    void parallel_for(std::size_t n, Fn fn)
+    {
+        TaskGroup group;
+        group.remaining = n;
+        // Each task captures only |call| and its index, which fits inside std::function without a heap allocation
+        struct Call
+        {
+            Fn &fn;
+            TaskGroup &group;
+        } call{fn, group};
+        for (std::size_t i = 0; i < n; i++)
+        {
+            submit([&call, i]
+            {
+                call.fn(i);
+                TaskGroup &group = call.group;
+                // Counted down under the lock so the caller can't see 0 and destroy |group| before this is done
+                std::lock_guard<std::mutex> lock(group.mutex);
+                if (group.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    group.finished.notify_all();
+                }
+            });
+        }
+        // The caller works through the queues too rather than sitting idle, which also means nested parallel_for
+        // calls from inside a task can't deadlock the pool. Once the queues are empty every task of this call has
+        // been picked up, so it's safe to block until the ones still running finish.
+        while (group.remaining.load(std::memory_order_acquire) != 0 && run_one_task())
+        {
+        }
+        std::unique_lock<std::mutex> lock(group.mutex);
+        group.finished.wait(lock, [&group] { return group.remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+private:
+    // Tracks the tasks of one parallel_for call
+    struct TaskGroup
+    {
+        std::atomic<std::size_t> remaining = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void worker_loop(std::size_t index);
+    // The queue owned by the current thread if it's one of this pool's workers, otherwise -1
+    int own_queue_index() const;
+    // Pops from |queue_index|'s own queue first then steals from the others. Returns false if every queue is empty.
+    bool run_one_task();
+    bool try_pop(std::size_t queue_index, bool steal, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> next_queue_ = 0;
+    std::atomic<std::size_t> pending_tasks_ = 0;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+#endif // THREAD_POOL_H_
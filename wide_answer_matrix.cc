@@ -0,0 +1,183 @@
+#include "wide_answer_matrix.h"
+
+#include "cpu_dispatch.h"
+#include "input_reader.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define WIDE_ANSWER_MATRIX_X86 1
+#endif
+
+namespace
+{
+
+// Each kernel reduces every group of |rows| delimited by |group_offsets| and adds the results to |totals|
+using ReduceFn = void (*)(std::span<const AnswerRow> rows, std::span<const uint32_t> group_offsets,
+                          WideAnswerTotals &totals);
+
+void add_group_scalar(const AnswerRow &anyone, const AnswerRow &everyone, WideAnswerTotals &totals)
+{
+    totals.counts.num_groups++;
+    totals.counts.anyone += anyone.count();
+    totals.counts.everyone += everyone.count();
+    for (int word = 0; word < kNumQuestionCodes / 64; word++)
+    {
+        for (uint64_t bits = anyone.words[word]; bits != 0; bits &= bits - 1)
+        {
+            totals.anyone_per_question[word * 64 + std::countr_zero(bits)]++;
+        }
+        for (uint64_t bits = everyone.words[word]; bits != 0; bits &= bits - 1)
+        {
+            totals.everyone_per_question[word * 64 + std::countr_zero(bits)]++;
+        }
+    }
+}
+
+void reduce_scalar(std::span<const AnswerRow> rows, std::span<const uint32_t> group_offsets, WideAnswerTotals &totals)
+{
+    for (std::size_t group = 0; group + 1 < group_offsets.size(); group++)
+    {
+        AnswerRow anyone;
+        AnswerRow everyone;
+        everyone.words.fill(~uint64_t{0});
+        for (uint32_t i = group_offsets[group]; i < group_offsets[group + 1]; i++)
+        {
+            for (int word = 0; word < kNumQuestionCodes / 64; word++)
+            {
+                anyone.words[word] |= rows[i].words[word];
+                everyone.words[word] &= rows[i].words[word];
+            }
+        }
+        add_group_scalar(anyone, everyone, totals);
+    }
+}
+
+#if defined(WIDE_ANSWER_MATRIX_X86)
+
+// Adds one to |counters[code]| for every code set in |row|. Each 32 bits of the row are spread over the 32 bytes of a
+// register (byte j gets byte j / 8 of the bits, then is compared against bit j % 8), which gives 0xff for the codes
+// that are set, and subtracting that adds one to their counters.
+__attribute__((target("avx2"))) void add_positional_counts_avx2(const AnswerRow &row, uint8_t *counters)
+{
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bit_of_byte = _mm256_set1_epi64x(0x8040201008040201);
+    for (int i = 0; i < kNumQuestionCodes / 32; i++)
+    {
+        uint32_t bits = static_cast<uint32_t>(row.words[i / 2] >> (32 * (i % 2)));
+        // Narrow alphabets (e.g. a-z) leave most of the row empty
+        if (bits == 0)
+        {
+            continue;
+        }
+        __m256i bytes = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(bits)), spread);
+        __m256i is_set = _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit_of_byte), bit_of_byte);
+        __m256i *counter = reinterpret_cast<__m256i *>(counters + 32 * i);
+        _mm256_store_si256(counter, _mm256_sub_epi8(_mm256_load_si256(counter), is_set));
+    }
+}
+
+__attribute__((target("avx2"))) void reduce_avx2(std::span<const AnswerRow> rows, std::span<const uint32_t> group_offsets,
+                                                 WideAnswerTotals &totals)
+{
+    // The per-question counts are kept in byte counters, which only take a few instructions per group, and are
+    // added to |totals| before they can overflow.
+    constexpr int kMaxPendingGroups = UINT8_MAX;
+    alignas(32) uint8_t anyone_counters[kNumQuestionCodes] = {};
+    alignas(32) uint8_t everyone_counters[kNumQuestionCodes] = {};
+    int pending_groups = 0;
+    auto flush_counters = [&]()
+    {
+        for (int code = 0; code < kNumQuestionCodes; code++)
+        {
+            totals.anyone_per_question[code] += anyone_counters[code];
+            totals.everyone_per_question[code] += everyone_counters[code];
+            anyone_counters[code] = 0;
+            everyone_counters[code] = 0;
+        }
+        pending_groups = 0;
+    };
+
+    for (std::size_t group = 0; group + 1 < group_offsets.size(); group++)
+    {
+        __m256i anyone = _mm256_setzero_si256();
+        __m256i everyone = _mm256_set1_epi8(-1);
+        for (uint32_t i = group_offsets[group]; i < group_offsets[group + 1]; i++)
+        {
+            __m256i row = _mm256_load_si256(reinterpret_cast<const __m256i *>(&rows[i]));
+            anyone = _mm256_or_si256(anyone, row);
+            everyone = _mm256_and_si256(everyone, row);
+        }
+        AnswerRow anyone_row;
+        AnswerRow everyone_row;
+        _mm256_store_si256(reinterpret_cast<__m256i *>(&anyone_row), anyone);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(&everyone_row), everyone);
+        totals.counts.num_groups++;
+        totals.counts.anyone += anyone_row.count();
+        totals.counts.everyone += everyone_row.count();
+        add_positional_counts_avx2(anyone_row, anyone_counters);
+        add_positional_counts_avx2(everyone_row, everyone_counters);
+        if (++pending_groups == kMaxPendingGroups)
+        {
+            flush_counters();
+        }
+    }
+    flush_counters();
+}
+
+#endif // WIDE_ANSWER_MATRIX_X86
+
+ReduceFn kernel()
+{
+#if defined(WIDE_ANSWER_MATRIX_X86)
+    // There is no SSE2 kernel, CPUs without AVX2 use the scalar one
+    return pick_simd_kernel(reduce_scalar, reduce_scalar, reduce_avx2);
+#else
+    return reduce_scalar;
+#endif
+}
+
+} // namespace
+
+WideAnswerMatrix WideAnswerMatrix::parse(std::string_view contents)
+{
+    WideAnswerMatrix matrix;
+    for_each_line(contents, [&matrix](std::string_view line)
+    {
+        if (line.empty())
+        {
+            matrix.end_group();
+            return;
+        }
+        AnswerRow row;
+        for (char answer : line)
+        {
+            row.set(static_cast<uint8_t>(answer));
+        }
+        matrix.add_person(row);
+    });
+    // The input doesn't have to end with a blank line
+    matrix.end_group();
+    return matrix;
+}
+
+void WideAnswerMatrix::add_person(const AnswerRow &row)
+{
+    rows_.push_back(row);
+}
+
+void WideAnswerMatrix::end_group()
+{
+    if (rows_.size() == group_offsets_.back())
+    {
+        return;
+    }
+    group_offsets_.push_back(static_cast<uint32_t>(rows_.size()));
+}
+
+WideAnswerTotals WideAnswerMatrix::sum_group_answers() const
+{
+    WideAnswerTotals totals;
+    kernel()(rows_, group_offsets_, totals);
+    return totals;
+}
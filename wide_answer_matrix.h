@@ -0,0 +1,79 @@
+#ifndef WIDE_ANSWER_MATRIX_H_
+#define WIDE_ANSWER_MATRIX_H_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "day_6_custom_customs.h"
+
+// Day 6 for survey forms with up to 256 question codes instead of 26 letters. The 32-bit answer_mask no longer fits,
+// so every person becomes a 256-bit row, the rows of a group are stored next to each other and a list of offsets
+// marks where each group starts (the same layout parsed_input_cache uses for day 6's masks). A group's "anyone" and
+// "everyone" answers are then an OR and an AND over its rows, which with AVX2 is one instruction per person, followed
+// by a popcount of four words. Like letter_count, the AVX2 kernel is picked at runtime with a plain loop as fallback.
+
+constexpr int kNumQuestionCodes = 256;
+
+// One person's answers, bit |code| set if they answered question |code| "yes". This is a std::bitset<256>, but with
+// the words exposed so a row can be loaded straight into a vector register.
+struct alignas(32) AnswerRow
+{
+    std::array<uint64_t, kNumQuestionCodes / 64> words = {};
+
+    void set(uint8_t code) { words[code >> 6] |= uint64_t{1} << (code & 63); }
+    bool test(uint8_t code) const { return (words[code >> 6] >> (code & 63)) & 1; }
+
+    int count() const
+    {
+        return std::popcount(words[0]) + std::popcount(words[1]) + std::popcount(words[2]) + std::popcount(words[3]);
+    }
+};
+
+struct WideAnswerTotals
+{
+    // The same sums as the 26-letter solver
+    GroupAnswerCounts counts;
+    // How many groups had anyone (or everyone) answer each question code "yes". Summed over every code these add up
+    // to |counts.anyone| and |counts.everyone|.
+    std::array<int64_t, kNumQuestionCodes> anyone_per_question = {};
+    std::array<int64_t, kNumQuestionCodes> everyone_per_question = {};
+};
+
+class WideAnswerMatrix
+{
+public:
+    // Parses day 6's format: a person per line and groups separated by blank lines. Every byte of a line is a question
+    // code, so a 26-letter input parses too (as codes 'a' through 'z'), but '\n' can't be used as a code in text form.
+    static WideAnswerMatrix parse(std::string_view contents);
+
+    // Adds a person to the current group
+    void add_person(const AnswerRow &row);
+
+    // Ends the current group. Only ended groups are counted, so call this after the last person too. Does nothing if
+    // the group is empty, so consecutive blank lines don't count as empty groups.
+    void end_group();
+
+    std::size_t num_groups() const { return group_offsets_.size() - 1; }
+    std::size_t num_people() const { return rows_.size(); }
+
+    std::span<const AnswerRow> group(std::size_t i) const
+    {
+        return std::span(rows_).subspan(group_offsets_[i], group_offsets_[i + 1] - group_offsets_[i]);
+    }
+
+    // Reduces every group and returns both parts' sums along with the per-question counts
+    WideAnswerTotals sum_group_answers() const;
+
+private:
+    std::vector<AnswerRow> rows_;
+    // Group i is rows [group_offsets_[i], group_offsets_[i + 1]). Rows past the last offset belong to the group that
+    // hasn't been ended yet.
+    std::vector<uint32_t> group_offsets_ = {0};
+};
+
+#endif // WIDE_ANSWER_MATRIX_H_